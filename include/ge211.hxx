@@ -5,13 +5,17 @@ namespace ge211 { }
 
 #include "ge211/base.hxx"
 #include "ge211/color.hxx"
+#include "ge211/controller.hxx"
 #include "ge211/error.hxx"
 #include "ge211/event.hxx"
 #include "ge211/geometry.hxx"
+#include "ge211/input.hxx"
+#include "ge211/particles.hxx"
 #include "ge211/audio.hxx"
 #include "ge211/resource.hxx"
 #include "ge211/random.hxx"
 #include "ge211/sprites.hxx"
+#include "ge211/tile_map.hxx"
 #include "ge211/time.hxx"
 #include "ge211/util.hxx"
 #include "ge211/version.hxx"
@@ -2,10 +2,13 @@
 
 #include "forward.hxx"
 #include "error.hxx"
+#include "geometry.hxx"
 #include "time.hxx"
 #include "util.hxx"
 
+#include <atomic>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 GE211_REGISTER_TYPE_NAME(ge211::Audio_clip);
@@ -14,6 +17,7 @@ GE211_REGISTER_TYPE_NAME(ge211::Mixer);
 GE211_REGISTER_TYPE_NAME(ge211::Music_track);
 GE211_REGISTER_TYPE_NAME(ge211::Sound_effect);
 GE211_REGISTER_TYPE_NAME(ge211::Sound_effect_handle);
+GE211_REGISTER_TYPE_NAME(ge211::Voice);
 
 namespace ge211 {
 
@@ -90,11 +94,29 @@ private:
 ///  - @ref Mixer::attach_music(Music_track)
 ///
 /// Note also that the mixer can only play one music track at a time.
+///
+/// Music is decoded while it plays. So that the audio device never waits
+/// for the disk, a music track loaded from a file is read ahead into a
+/// buffer by a background thread, and the decoder reads from the buffer;
+/// @ref Music_track::get_stream_stats reports how that is going.
 class Music_track : public Audio_clip
 {
     friend Mixer;
 
 public:
+    /// Statistics about reading a music track ahead of its decoder, as
+    /// returned by @ref Music_track::get_stream_stats.
+    struct Stream_stats
+    {
+        /// How many bytes of the file have been read ahead.
+        size_t buffered_bytes;
+        /// The size of the read-ahead buffer, in bytes.
+        size_t buffer_capacity;
+        /// How many times the decoder had to wait for the file to be
+        /// read. If this keeps increasing, the disk is too slow.
+        unsigned long underruns;
+    };
+
     /// Loads a new music track from a resource file.
     ///
     /// Supported file formats may include WAV, MP3, OGG, FLAC, MID,
@@ -112,12 +134,19 @@ public:
     /// Default-constructs the empty music track.
     Music_track() { }
 
+    /// Returns statistics about reading this track ahead of its decoder.
+    /// They are all zero if the track is empty or wasn't loaded from a
+    /// file, for example because it came from the resource pack, which
+    /// is in memory already.
+    Stream_stats get_stream_stats() const;
+
 private:
     bool real_try_load_(const std::string&, const Mixer&) override;
     void real_clear_() override;
     bool real_empty_() const override;
 
     std::shared_ptr<Mix_Music> ptr_;
+    std::shared_ptr<detail::Music_stream> stream_;
 };
 
 /// A sound effect track, which can be attached to a Mixer channel and played.
@@ -147,12 +176,46 @@ public:
     /// Default-constructs the empty sound effect track.
     Sound_effect() { }
 
+    /// \name Voice management
+    ///
+    /// These settings control what the @ref Mixer does when there are
+    /// more sound effects to play than it has channels. They travel with
+    /// the Sound_effect (and its copies), and take effect when it is
+    /// passed to @ref Mixer::play_effect. See
+    /// @ref Mixer::set_voice_stealing for how they are used.
+    ///@{
+
+    /// Returns this effect's priority. The default priority is 0.
+    int get_priority() const { return priority_; }
+
+    /// Sets this effect's priority. When the mixer needs to stop one
+    /// effect to play another, it never stops an effect with a higher
+    /// priority than the new one.
+    void set_priority(int priority) { priority_ = priority; }
+
+    /// Returns the maximum number of copies of this effect, that is,
+    /// Sound_effect%s loaded from the same file, that may play at once.
+    /// The default, 0, means no limit.
+    int get_max_instances() const { return max_instances_; }
+
+    /// Sets the maximum number of copies of this effect that may play at
+    /// once, or 0 for no limit.
+    ///
+    /// \preconditions
+    ///  - `max_instances >= 0`, throws exceptions::Client_logic_error if
+    ///    violated.
+    void set_max_instances(int max_instances);
+
+    ///@}
+
 private:
     bool real_try_load_(const std::string&, const Mixer&) override;
     void real_clear_() override;
     bool real_empty_() const override;
 
     std::shared_ptr<Mix_Chunk> ptr_;
+    int priority_ = 0;
+    int max_instances_ = 0;
 };
 
 /// The entity that coordinates playing all audio tracks.
@@ -203,6 +266,34 @@ class Mixer
     friend class util::pointers::Lazy_ptr<Mixer>;
 
 public:
+    /// Options for opening the audio device, which can be chosen by
+    /// overriding @ref Abstract_game::initial_mixer_config.
+    ///
+    /// The device's buffer size is the main contributor to audio
+    /// latency: a sound effect can't start playing until the buffer
+    /// being played when it is requested has finished. The default of
+    /// 1024 frames is about 23 ms at 44.1 kHz, or 46 ms at 22.05 kHz.
+    /// Smaller buffers reduce latency but make dropouts more likely on a
+    /// busy computer.
+    struct Config
+    {
+        /// The sample rate, in Hz, or 0 for SDL_mixer's default,
+        /// `MIX_DEFAULT_FREQUENCY`, which is 44100 Hz as of SDL_mixer
+        /// 2.6 and 22050 Hz before that.
+        int frequency = 0;
+        /// The number of output channels: 1 for mono, 2 for stereo.
+        int output_channels = 2;
+        /// The size of the device buffer, in sample frames. Must be a
+        /// power of two.
+        int buffer_frames = 1024;
+        /// The initial number of effect channels. See
+        /// @ref Mixer::set_effect_channel_count.
+        int effect_channels = 8;
+        /// The maximum number of voices that @ref Mixer::play_voice
+        /// can play at once, or 0 to disable software voices.
+        int software_voices = 256;
+    };
+
     /// The state of an audio channel.
     enum class State
     {
@@ -222,6 +313,27 @@ public:
     /// play audio, but if it isn't, audio operations will fail.
     bool is_enabled() const { return enabled_; }
 
+    /// \name Audio device
+    ///@{
+
+    /// Returns the configuration actually in effect, which may differ
+    /// from what was requested if the audio device doesn't support it.
+    Config const& get_config() const { return config_; }
+
+    /// Returns the output latency due to buffering: the length of one
+    /// device buffer. Once audio has been mixed, this uses the buffer
+    /// size observed while mixing rather than the requested one.
+    Duration get_latency() const;
+
+    /// Returns the average time between the audio device's requests for
+    /// more audio, as measured while mixing, or zero if too little
+    /// audio has been mixed to tell. This should be close to
+    /// @ref Mixer::get_latency; if it is much longer, then the device
+    /// is buffering more than it reports.
+    Duration get_measured_mix_period() const;
+
+    ///@}
+
     /// \name Playing music
     ///@{
 
@@ -309,6 +421,21 @@ public:
 
     ///@}
 
+    /// What to do when a sound effect is played but there is no room
+    /// for it, either because all channels are in use or because too
+    /// many copies of the effect are already playing. See
+    /// @ref Mixer::set_voice_stealing.
+    enum class Voice_stealing
+    {
+        /// Don't play the new effect.
+        none,
+        /// Stop the effect that has been playing longest.
+        oldest,
+        /// Stop the effect playing at the lowest volume, or if there is
+        /// a tie, the one that has been playing longest.
+        quietest,
+    };
+
     /// \name Playing sound effects
     ///@{
 
@@ -321,21 +448,53 @@ public:
     /// The volume must be in the unit interval. Returns a Sound_effect_handle,
     /// which can be used to control the sound effect while it's playing.
     ///
+    /// If no channel is available, or if `effect.get_max_instances()`
+    /// copies of the effect are already playing, then the mixer may stop
+    /// another effect to make room, according to the current
+    /// @ref Mixer::set_voice_stealing policy.
+    ///
     /// \preconditions
-    ///  - `available_effect_channels() > 0`, throws exceptions::Mixer_error if
-    ///     violated.
+    ///  - There is room for the effect, as described above, throws
+    ///    exceptions::Mixer_error if violated.
     ///  - `!effect.empty()`, undefined behavior if violated.
     Sound_effect_handle
     play_effect(Sound_effect effect, double volume = 1.0);
 
     /// Attempts to play the given effect track on this mixer, returning an
-    /// empty Sound_effect_handle if no effect channel is available.
+    /// empty Sound_effect_handle if there is no room for it, as described
+    /// for @ref Mixer::play_effect.
     ///
     /// \preconditions
     ///  - `!effect.empty()`, undefined behavior if violated.
     Sound_effect_handle
     try_play_effect(Sound_effect effect, double volume = 1.0);
 
+    /// Returns the current voice-stealing policy. The default is
+    /// `Voice_stealing::none`.
+    Voice_stealing get_voice_stealing() const { return voice_stealing_; }
+
+    /// Sets what to do when there is no room to play a sound effect.
+    /// Unless the policy is `Voice_stealing::none`, the mixer stops one
+    /// of the playing effects whose priority is no higher than the new
+    /// effect's, preferring the lowest priority and then choosing by
+    /// the policy. If the new effect is over its instance limit, only
+    /// copies of the same effect are considered.
+    void set_voice_stealing(Voice_stealing policy)
+    { voice_stealing_ = policy; }
+
+    /// Returns the number of effect channels, which is the maximum
+    /// number of sound effects that can play at once. The initial
+    /// number is usually 8.
+    int get_effect_channel_count() const;
+
+    /// Changes the number of effect channels. If this reduces the
+    /// number of channels, effects playing on the removed channels are
+    /// stopped.
+    ///
+    /// \preconditions
+    ///  - `count > 0`, throws exceptions::Client_logic_error if violated.
+    void set_effect_channel_count(int count);
+
     /// Pauses all currently-playing effects.
     void pause_all_effects();
 
@@ -344,6 +503,168 @@ public:
 
     ///@}
 
+    /// How positional sound effects fade with distance from the
+    /// listener and pan with horizontal offset. See
+    /// @ref Mixer::set_attenuation.
+    struct Attenuation
+    {
+        /// Effects this close to the listener play at full volume.
+        double reference_distance = 100;
+        /// Beyond the reference distance, volume falls linearly,
+        /// reaching zero at this distance. Effects this far away or
+        /// farther are culled.
+        double max_distance = 1000;
+        /// An effect this far to the left or right of the listener is
+        /// panned entirely to that side.
+        double pan_distance = 500;
+    };
+
+    /// \name Positional sound effects
+    ///
+    /// A sound effect can be given a position in the game's world,
+    /// usually that of the sprite making the sound, using
+    /// @ref Mixer::play_effect_at or @ref Sound_effect_handle::set_position.
+    /// Its volume and stereo panning then depend on where it is relative
+    /// to the *listener*, usually the player or the center of the view.
+    /// Once per frame, the mixer updates the panning of every positional
+    /// effect, and stops any that have moved out of earshot, so that they
+    /// don't occupy channels.
+    ///@{
+
+    /// Plays the given effect at a position, as by @ref Mixer::play_effect.
+    /// Returns the empty handle without playing the effect if it is too
+    /// far from the listener to be heard.
+    ///
+    /// \preconditions
+    ///  - There is room for the effect if it is audible, as for
+    ///    @ref Mixer::play_effect; throws exceptions::Mixer_error if
+    ///    violated.
+    ///  - `!effect.empty()`, undefined behavior if violated.
+    Sound_effect_handle
+    play_effect_at(Sound_effect effect,
+                   Posn<double> position,
+                   double volume = 1.0);
+
+    /// Attempts to play the given effect at a position, returning the
+    /// empty handle if it is out of earshot or there is no room for it.
+    ///
+    /// \preconditions
+    ///  - `!effect.empty()`, undefined behavior if violated.
+    Sound_effect_handle
+    try_play_effect_at(Sound_effect effect,
+                       Posn<double> position,
+                       double volume = 1.0);
+
+    /// Returns the listener's position. Initially this is the origin.
+    Posn<double> get_listener_position() const { return listener_; }
+
+    /// Moves the listener.
+    void set_listener_position(Posn<double> position)
+    { listener_ = position; }
+
+    /// Returns how positional effects are attenuated.
+    Attenuation const& get_attenuation() const { return attenuation_; }
+
+    /// Changes how positional effects are attenuated.
+    ///
+    /// \preconditions
+    ///  - `0 <= reference_distance < max_distance` and
+    ///    `pan_distance > 0`; throws exceptions::Client_logic_error if
+    ///    violated.
+    void set_attenuation(Attenuation const&);
+
+    /// Returns how many positional effects have been culled, either
+    /// when played or later, for being out of earshot.
+    unsigned long get_culled_effect_count() const { return culled_effects_; }
+
+    ///@}
+
+    /// \name Software voices
+    ///
+    /// In addition to its effect channels, the mixer can play sound
+    /// effects as *voices*, which it mixes itself after SDL_mixer has
+    /// mixed the channels. Voices are cheaper than channels, so many
+    /// more of them can play at once (see @ref Config::software_voices),
+    /// and each can be panned, played at a different pitch, and faded
+    /// smoothly to a new gain while it plays. Voices don't use effect
+    /// channels, so voice stealing and @ref Mixer::pause_all_effects
+    /// don't affect them.
+    ///
+    /// Software voices require the audio device to use 16-bit samples
+    /// and one or two output channels, which it almost always does.
+    ///@{
+
+    /// Plays the given effect as a new voice, returning a @ref Voice
+    /// handle for controlling it, or an empty handle if the mixer is
+    /// disabled, software voices are unsupported or disabled, or the
+    /// maximum number of voices are already playing.
+    ///
+    /// `gain` scales the amplitude of the effect, so 1.0 plays it as
+    /// recorded; `pan` ranges from -1.0 (left) through 0.0 (center) to
+    /// 1.0 (right); and `pitch` is the playback rate, so 2.0 plays the
+    /// effect an octave higher and twice as fast. If `loop` is true,
+    /// the voice repeats until stopped.
+    ///
+    /// \preconditions
+    ///  - `gain >= 0`, `-1 <= pan <= 1`, and `pitch > 0`; throws
+    ///    exceptions::Client_logic_error if violated.
+    ///  - `!effect.empty()`, undefined behavior if violated.
+    Voice play_voice(Sound_effect effect,
+                     double gain = 1.0,
+                     double pan = 0.0,
+                     double pitch = 1.0,
+                     bool loop = false);
+
+    /// Returns the number of voices playing.
+    int get_voice_count() const;
+
+    ///@}
+
+    /// \name Loading sound effects
+    ///
+    /// The mixer keeps the decoded samples of every @ref Sound_effect
+    /// loaded through it, so constructing a second Sound_effect from the
+    /// same file shares the first one's samples instead of decoding the
+    /// file again. Since decoding compressed formats such as OGG and MP3
+    /// can be slow, you can also ask the mixer to start decoding files in
+    /// the background, for example while showing a title screen, so that
+    /// constructing the Sound_effect%s later is fast.
+    ///@{
+
+    /// Starts decoding the given sound effect file on a background
+    /// thread. Constructing a Sound_effect from the same file afterward
+    /// uses the decoded samples, waiting for decoding to finish if
+    /// necessary. Does nothing if the mixer is not enabled.
+    ///
+    /// Throws exceptions::File_open_error if the file cannot be found.
+    void preload_effect(const std::string& filename);
+
+    /// Statistics about the decoded sound effect cache, as returned by
+    /// @ref Mixer::effect_cache_stats().
+    struct Effect_cache_stats
+    {
+        /// The number of decoded files in the cache.
+        size_t entries;
+        /// The total size, in bytes, of the decoded samples in the cache.
+        size_t pcm_bytes;
+        /// How many preloads are still being decoded.
+        size_t pending;
+        /// How many Sound_effect%s have been constructed by reusing
+        /// cached samples.
+        size_t hits;
+        /// How many files have been decoded.
+        size_t misses;
+    };
+
+    /// Returns statistics about the decoded sound effect cache.
+    Effect_cache_stats effect_cache_stats() const;
+
+    /// Removes from the cache all samples that are not currently used by
+    /// any Sound_effect.
+    void evict_unused_effects();
+
+    ///@}
+
     ///\name Constructors, assignment operators, and destructor
     ///@{
 
@@ -365,32 +686,101 @@ private:
     /// Private constructor -- should only be called by
     /// Abstract_game::mixer() via lazy_ptr<Mixer>.
     Mixer();
+    explicit Mixer(Config const&);
+
+    /// Registered with SDL_mixer to observe each buffer as it is mixed.
+    /// Runs on the audio thread.
+    static void observe_mix_(int, void*, int len, void* self);
 
     /// Updates the state of the channels.
     void poll_channels_();
 
+    /// Updates the panning of positional effects and culls those out of
+    /// earshot.
+    void update_positional_effects_();
+
+    /// Applies a positional effect's panning for its current position.
+    /// Returns false if it is out of earshot.
+    bool apply_position_(Sound_effect_handle const&);
+
     friend class detail::Engine; // calls poll_channels_().
 
     /// Returns the index of an empty channel. Returns -1 if all
     /// are full.
     int find_empty_channel_() const;
 
+    /// Called by SDL_mixer, possibly on the audio thread, when a
+    /// channel finishes playing.
+    static void on_channel_finished_(int channel);
+
+    /// Unregisters the effect on a channel reported finished, if it
+    /// really is.
+    void release_finished_channel_(int channel);
+
     /// Registers an effect with a channel.
     Sound_effect_handle
     register_effect_(int channel, Sound_effect effect);
 
     /// Unregisters the effect associated with a channel.
     void unregister_effect_(int channel);
+
+    /// Finds a channel for the given effect, stopping another effect
+    /// if the voice-stealing policy allows. Returns -1 if there's no
+    /// room.
+    int allocate_channel_(Sound_effect const& effect);
+
+    /// Chooses an active channel to steal among those whose effect
+    /// has priority no higher than `priority` and, if `chunk` is
+    /// non-null, plays `chunk`. Returns -1 if none qualifies.
+    int choose_victim_(int priority, Mix_Chunk const* chunk) const;
     friend Sound_effect_handle; // calls unregister_effect_(int).
 
+    /// Starts the software mixing stage, if necessary and possible.
+    /// Returns null if it can't be started.
+    detail::Software_mixer* start_software_mixer_();
+
 private:
     Music_track current_music_;
     State music_state_{State::detached};
     detail::Pausable_timer music_position_{true};
 
+    Config config_;
+    int bytes_per_frame_{0};
     bool enabled_;
     std::vector<Sound_effect_handle> channels_;
-    int available_effect_channels_;
+
+    // Unused channels, as a stack.
+    std::vector<int> free_channels_;
+    // Channels with an effect registered, in no particular order.
+    std::vector<int> active_channels_;
+    // Each channel's index in active_channels_, or -1 if inactive.
+    std::vector<int> active_index_;
+
+    // How many channels are playing each chunk.
+    std::unordered_map<Mix_Chunk const*, int> instance_counts_;
+
+    Voice_stealing voice_stealing_{Voice_stealing::none};
+
+    // Counts effects started, to order them by age.
+    unsigned long effects_started_{0};
+
+    Posn<double> listener_{0, 0};
+    Attenuation attenuation_;
+    unsigned long culled_effects_{0};
+
+    // Written by observe_mix_() on the audio thread.
+    std::atomic<int> mix_buffer_bytes_{0};
+    std::atomic<long> mix_count_{0};
+    std::atomic<long long> first_mix_ns_{0};
+    std::atomic<long long> last_mix_ns_{0};
+
+    friend Sound_effect; // loads through effect_cache_.
+    std::unique_ptr<detail::Effect_cache> effect_cache_;
+
+    // Started on the first call to play_voice().
+    friend Voice;        // controls voices through software_mixer_.
+    std::unique_ptr<detail::Software_mixer> software_mixer_;
+    bool software_mixer_supported_{false};
 };
 
 /// Used to control a Sound_effect after it is started playing on a Mixer.
@@ -462,28 +852,129 @@ public:
     /// 1.0.
     void set_volume(double unit_value);
 
+    /// Returns whether the effect has a position. See
+    /// @ref Mixer::play_effect_at.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    bool is_positional() const;
+
+    /// Returns the effect's position, or the origin if it isn't
+    /// positional.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    Posn<double> get_position() const;
+
+    /// Moves the effect, making it positional if it wasn't. Its panning
+    /// changes, or it is culled if out of earshot, between frames.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    void set_position(Posn<double> position);
+
 private:
     friend Mixer;
 
     struct Impl_
     {
-        Impl_(Mixer& m, Sound_effect e, int c)
+        Impl_(Mixer& m, Sound_effect e, int c, unsigned long s)
                 : mixer(m),
                   effect(std::move(e)),
                   channel(c),
-                  state(Mixer::State::playing) { }
+                  state(Mixer::State::playing),
+                  serial(s) { }
 
         Mixer& mixer;
         Sound_effect effect;
         int channel;
         Mixer::State state;
+        // Orders effects by when they started playing.
+        unsigned long serial;
+
+        bool positional = false;
+        Posn<double> position{0, 0};
+        // The panning last applied, to skip redundant updates.
+        int left = -1;
+        int right = -1;
     };
 
-    Sound_effect_handle(Mixer&, Sound_effect, int channel);
+    Sound_effect_handle(Mixer&, Sound_effect, int channel,
+                        unsigned long serial);
 
     std::shared_ptr<Impl_> ptr_;
 };
 
+/// Used to control a sound effect played as a software voice.
+///
+/// This is returned by @ref Mixer::play_voice. Once the voice has
+/// finished, whether by reaching its end or being stopped, the member
+/// functions that control it have no effect.
+class Voice
+{
+public:
+    /// Default-constructs the empty voice handle, which is not associated
+    /// with a voice.
+    Voice() { }
+
+    /// Recognizes the empty voice handle.
+    bool empty() const { return mixer_ == nullptr; }
+
+    /// Recognizes a non-empty voice handle.
+    /// Equivalent to `!empty()`.
+    explicit operator bool() const { return !empty(); }
+
+    /// Returns whether the voice is still playing. This changes only
+    /// between frames, so it remains true until the frame after the
+    /// voice is stopped.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    bool is_playing() const;
+
+    /// Changes the voice's gain, moving to the new gain linearly over
+    /// the given duration rather than all at once, to avoid clicks.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    ///  - `gain >= 0`, throws exceptions::Client_logic_error if violated.
+    void set_gain(double gain, Duration ramp = Duration(0));
+
+    /// Changes the voice's position from -1.0 (left) to 1.0 (right).
+    /// Panning uses a constant-power law, so a voice panned all the way
+    /// to one side is about 3 dB louder in that speaker than a
+    /// centered voice. Has no effect when the output is mono.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    ///  - `-1 <= pan <= 1`, throws exceptions::Client_logic_error if
+    ///    violated.
+    void set_pan(double pan);
+
+    /// Changes the voice's playback rate.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    ///  - `pitch > 0`, throws exceptions::Client_logic_error if violated.
+    void set_pitch(double pitch);
+
+    /// Stops the voice.
+    ///
+    /// \preconditions
+    ///  - `!empty()`, undefined behavior if violated.
+    void stop();
+
+private:
+    friend Mixer;
+
+    Voice(Mixer& mixer, uint32_t id)
+            : mixer_(&mixer),
+              id_(id) { }
+
+    Mixer* mixer_ = nullptr;
+    uint32_t id_ = 0;
+};
+
 } // end namespace audio
 
 } // end namespace ge211
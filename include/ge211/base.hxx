@@ -2,12 +2,14 @@
 
 #include "audio.hxx"
 #include "color.hxx"
+#include "controller.hxx"
 #include "error.hxx"
 #include "event.hxx"
 #include "forward.hxx"
 #include "frame.hxx"
 #include "geometry.hxx"
 #include "doxygen.hxx"
+#include "input.hxx"
 #include "random.hxx"
 #include "resource.hxx"
 #include "session.hxx"
@@ -245,6 +247,13 @@ protected:
     /// This is only called by the engine once at startup.
     virtual std::string initial_window_title() const;
 
+    /// Override this function to configure the audio device, for
+    /// example to choose a smaller buffer for lower latency. This is
+    /// called once, when mixer() is first called, so to change the
+    /// configuration you must override this rather than calling mixer()
+    /// first. See audio::Mixer::Config for the options.
+    virtual Mixer::Config initial_mixer_config() const;
+
     ///@}
 
     /// \name Functions to be called by clients
@@ -260,11 +269,57 @@ protected:
     /// called before the window is created by `run()`.
     Window& get_window() const;
 
+    /// Returns a snapshot of the keyboard and mouse as of the start of
+    /// the current frame. This is kept up to date in either input mode.
+    Input_state const& input() const NOEXCEPT
+    { return input_.state(); }
+
+    /// Returns how the engine delivers input to the game.
+    Input_mode get_input_mode() const NOEXCEPT
+    { return input_mode_; }
+
+    /// Changes how the engine delivers input to the game, starting with
+    /// the next frame. In Input_mode::snapshot, the input callbacks,
+    /// including the default on_key_down(Key) that quits when escape is
+    /// pressed, are no longer called, and the game instead reads input().
+    /// This saves a virtual call per event, which adds up with a mouse
+    /// that reports its position a thousand times per second.
+    void set_input_mode(Input_mode mode) NOEXCEPT
+    { input_mode_ = mode; }
+
+    /// Returns a snapshot of the given game controller as of the start
+    /// of the current frame. Up to four controllers are numbered from 0
+    /// in the order they were connected. For any number that has no
+    /// controller, the result's Controller_state::is_connected returns
+    /// false.
+    Controller_state const& controller(size_t index = 0) const NOEXCEPT
+    { return controllers_.state(index); }
+
+    /// Vibrates the given game controller. The `low` and `high`
+    /// strengths, for the low- and high-frequency motors, range from 0
+    /// to 1. A new call replaces any rumble in progress; a call with
+    /// both strengths 0 stops it. Returns false if the controller isn't
+    /// connected or doesn't support rumble, or if SDL is older than
+    /// 2.0.9, which added rumble.
+    bool rumble_controller(size_t index, double low, double high,
+                           Duration duration)
+    { return controllers_.rumble(index, float(low), float(high), duration); }
+
+    /// Returns the deadzone applied to controller sticks and triggers.
+    Controller_deadzone const& get_controller_deadzone() const NOEXCEPT
+    { return controllers_.deadzone(); }
+
+    /// Changes the deadzone applied to controller sticks and triggers,
+    /// starting with the next frame.
+    void set_controller_deadzone(Controller_deadzone const& dz) NOEXCEPT
+    { controllers_.set_deadzone(dz); }
+
     /// Gets access to the audio mixer, which can be used to play
     /// music and sound effects.
     Mixer& mixer() const
     {
-        return *mixer_;
+        return mixer_.is_forced() ? *mixer_
+                                  : mixer_.force(initial_mixer_config());
     }
 
     /// Gets the time point at which the current frame started. This can be
@@ -287,6 +342,28 @@ protected:
     double get_load_percent() const NOEXCEPT
     { return clock_.load_fraction() * 100; }
 
+    /// Returns how many sprites were drawn in the previous frame.
+    size_t get_drawn_sprite_count() const NOEXCEPT;
+
+    /// Returns how many sprites were culled in the previous frame,
+    /// because they fell entirely outside the window.
+    size_t get_culled_sprite_count() const NOEXCEPT;
+
+    /// Returns whether sprites outside the window are culled.
+    bool get_sprite_culling() const NOEXCEPT
+    { return sprite_culling_; }
+
+    /// Changes whether sprites outside the window are culled. Culling is
+    /// on by default, so that a game can add a whole scrolling level to
+    /// the Sprite_set and pay to render only the part that's visible.
+    /// A sprite is culled when the rectangle given by its
+    /// Sprite::dimensions() const, placed and transformed as given to
+    /// Sprite_set::add_sprite, falls entirely outside the window. If
+    /// you define your own sprite that renders outside its dimensions,
+    /// turn culling off.
+    void set_sprite_culling(bool enabled) NOEXCEPT
+    { sprite_culling_ = enabled; }
+
     /// Prepares a sprites::Sprite for rendering, without actually including it
     /// in the scene. The first time a sprites::Sprite is rendered, it ordinarily
     /// has to be converted and transferred to video memory. This function
@@ -315,7 +392,11 @@ private:
     util::pointers::Lazy_ptr<Mixer> mixer_;
     detail::Engine *engine_ = nullptr;
     bool quit_ = false;
+    bool sprite_culling_ = true;
     detail::Frame_clock clock_;
+    detail::Input_tracker input_;
+    detail::Controller_tracker controllers_;
+    Input_mode input_mode_ = Input_mode::callbacks;
 };
 
 }
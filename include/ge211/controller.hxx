@@ -0,0 +1,186 @@
+#pragma once
+
+#include "forward.hxx"
+#include "doxygen.hxx"
+#include "geometry.hxx"
+#include "time.hxx"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+GE211_REGISTER_TYPE_NAME(ge211::Controller_axis);
+GE211_REGISTER_TYPE_NAME(ge211::Controller_button);
+GE211_REGISTER_TYPE_NAME(ge211::Controller_deadzone);
+GE211_REGISTER_TYPE_NAME(ge211::Controller_state);
+
+namespace ge211 {
+
+namespace events {
+
+/// A button on a game controller. The names follow the Xbox layout;
+/// other controllers are mapped so that, for example, `a` is the bottom
+/// face button.
+enum class Controller_button
+{
+    a, b, x, y,
+    back, guide, start,
+    left_stick, right_stick,
+    left_shoulder, right_shoulder,
+    dpad_up, dpad_down, dpad_left, dpad_right,
+};
+
+/// An analog axis on a game controller.
+enum class Controller_axis
+{
+    /// The left stick's horizontal axis, from -1 (left) to 1 (right).
+    left_x,
+    /// The left stick's vertical axis, from -1 (up) to 1 (down).
+    left_y,
+    /// The right stick's horizontal axis.
+    right_x,
+    /// The right stick's vertical axis.
+    right_y,
+    /// The left trigger, from 0 (released) to 1 (fully pulled).
+    left_trigger,
+    /// The right trigger.
+    right_trigger,
+};
+
+/// How far the sticks and triggers must move, as a fraction of their
+/// range, before they read as anything but zero. Worn sticks rarely
+/// return exactly to center, so without a deadzone a character would
+/// drift. Beyond the deadzone, values are rescaled to start from zero,
+/// so that small movements are still possible.
+struct Controller_deadzone
+{
+    /// The deadzone for each stick, which applies to the distance of
+    /// the stick from center, so that diagonal movement isn't clipped.
+    float stick = 0.25f;
+
+    /// The deadzone for each trigger.
+    float trigger = 0.1f;
+};
+
+/// A snapshot of one game controller, as of the start of the current
+/// frame, returned by Abstract_game::controller.
+///
+/// The engine reads every button and axis of every connected
+/// controller once per frame, so querying this is cheap, and there are
+/// no callbacks to override. Controllers are numbered in the order they
+/// were connected; when a controller is unplugged, its number becomes
+/// free for the next controller plugged in.
+class Controller_state
+{
+public:
+    /// The number of buttons in Controller_button.
+    static constexpr size_t button_count = 15;
+
+    /// The number of axes in Controller_axis.
+    static constexpr size_t axis_count = 6;
+
+    /// Is this controller plugged in? If not, no buttons are down and
+    /// every axis reads zero.
+    bool is_connected() const NOEXCEPT
+    { return connected_; }
+
+    /// Is the given button held down?
+    bool is_down(Controller_button button) const NOEXCEPT
+    { return down_[size_t(button)]; }
+
+    /// Did the given button go down since the previous frame?
+    bool was_pressed(Controller_button button) const NOEXCEPT
+    { return pressed_[size_t(button)]; }
+
+    /// Did the given button go up since the previous frame?
+    bool was_released(Controller_button button) const NOEXCEPT
+    { return released_[size_t(button)]; }
+
+    /// The position of the given axis, with the deadzone applied.
+    float axis(Controller_axis axis) const NOEXCEPT
+    { return axes_[size_t(axis)]; }
+
+    /// The position of the left stick, with each coordinate from -1
+    /// to 1. Positive `height` is down, as in screen coordinates.
+    Dims<float> left_stick() const NOEXCEPT
+    { return {axis(Controller_axis::left_x), axis(Controller_axis::left_y)}; }
+
+    /// The position of the right stick.
+    Dims<float> right_stick() const NOEXCEPT
+    {
+        return {axis(Controller_axis::right_x),
+                axis(Controller_axis::right_y)};
+    }
+
+private:
+    friend detail::Controller_tracker;
+
+    std::array<float, axis_count> axes_{};
+    std::bitset<button_count> down_;
+    std::bitset<button_count> pressed_;
+    std::bitset<button_count> released_;
+    bool connected_ = false;
+};
+
+} // end namespace events
+
+namespace detail {
+
+// Applies a radial deadzone to a stick position, rescaling the rest of
+// the range to start from zero and clamping it to the unit circle.
+Dims<float> apply_stick_deadzone(Dims<float>, float deadzone) NOEXCEPT;
+
+// Applies a deadzone to a trigger position.
+float apply_trigger_deadzone(float, float deadzone) NOEXCEPT;
+
+// Opens controllers as they are plugged in and builds their
+// Controller_states.
+class Controller_tracker
+{
+public:
+    // The most controllers that can be connected at once.
+    static constexpr size_t max_controllers = 4;
+
+    using Buttons = std::bitset<Controller_state::button_count>;
+    using Axes = std::array<int16_t, Controller_state::axis_count>;
+
+    Controller_tracker() = default;
+    Controller_tracker(Controller_tracker const&) = delete;
+    Controller_tracker& operator=(Controller_tracker const&) = delete;
+    ~Controller_tracker();
+
+    // Handles SDL_CONTROLLERDEVICEADDED, which takes a device index.
+    void device_added(int device_index);
+
+    // Handles SDL_CONTROLLERDEVICEREMOVED, which takes an instance ID.
+    void device_removed(int32_t instance_id);
+
+    // Reads the buttons and axes of every connected controller.
+    void update();
+
+    // Updates one controller's state from raw button and axis values.
+    void update(size_t index, Buttons const&, Axes const&) NOEXCEPT;
+
+    // Returns false if the controller isn't connected or can't rumble.
+    bool rumble(size_t index, float low, float high, Duration);
+
+    Controller_state const& state(size_t index) const NOEXCEPT;
+
+    Controller_deadzone const& deadzone() const NOEXCEPT
+    { return deadzone_; }
+
+    void set_deadzone(Controller_deadzone const& deadzone) NOEXCEPT
+    { deadzone_ = deadzone; }
+
+private:
+    void close_(size_t index) NOEXCEPT;
+
+    std::array<Controller_state, max_controllers> states_;
+    std::array<SDL_GameController*, max_controllers> handles_{};
+    std::array<int32_t, max_controllers> instance_ids_{};
+    Controller_deadzone deadzone_;
+};
+
+} // end namespace detail
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "forward.hxx"
+#include "audio.hxx"
+#include "resource.hxx"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+struct Mix_Chunk;
+
+namespace ge211 {
+
+namespace detail {
+
+// Holds the decoded samples of every sound effect loaded through a
+// Mixer, keyed by resolved path, so that loading the same file again
+// shares the existing chunk instead of decoding it again. Files can
+// also be decoded ahead of time by a small pool of worker threads;
+// finished chunks are handed to the main thread by `publish()`.
+//
+// Except where noted, member functions must be called on the main
+// thread.
+class Effect_cache
+{
+public:
+    using Chunk_ptr = std::shared_ptr<Mix_Chunk>;
+
+    // Finds a resource without opening it, throwing File_open_error if
+    // it doesn't exist.
+    using Locator = std::function<Resource_location(std::string const&)>;
+
+    // Decodes a resource, returning nullptr if it can't be decoded.
+    // Called on the worker threads as well as the main thread.
+    using Decoder = std::function<Chunk_ptr(std::string const&)>;
+
+    // Finds resources with File_resource::locate and decodes them with
+    // SDL_mixer.
+    Effect_cache();
+
+    // Finds and decodes resources with the given functions instead,
+    // for testing.
+    Effect_cache(Locator, Decoder);
+
+    // Stops the workers, abandoning any unstarted jobs.
+    ~Effect_cache();
+
+    // Returns the chunk for the named resource, decoding it now unless
+    // it is cached or being decoded already. Returns nullptr if the
+    // file can't be decoded. Throws File_open_error if it doesn't exist.
+    Chunk_ptr load(std::string const& filename);
+
+    // Starts decoding the named resource on a worker thread, unless it
+    // is cached or being decoded already. Throws File_open_error if it
+    // doesn't exist.
+    void preload(std::string const& filename);
+
+    // Moves chunks decoded by the workers into the cache.
+    void publish();
+
+    Mixer::Effect_cache_stats stats() const;
+
+    void evict_unused();
+
+    void clear();
+
+private:
+    struct Entry_
+    {
+        long long mtime;
+        Chunk_ptr chunk;
+    };
+
+    struct Job_
+    {
+        std::string filename;
+        Resource_location location;
+    };
+
+    // Caps the worker pool, since decoding is mostly memory-bound.
+    static unsigned const max_workers = 4;
+
+    bool find_(Resource_location const&, Chunk_ptr& out) const;
+    void work_();
+
+    Locator locate_;
+    Decoder decode_;
+
+    // Main thread only:
+    std::unordered_map<std::string, Entry_> map_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+
+    // Shared with the workers, guarded by lock_:
+    mutable std::mutex lock_;
+    std::condition_variable job_ready_;
+    std::condition_variable job_done_;
+    std::deque<Job_> jobs_;
+    std::vector<std::pair<Resource_location, Chunk_ptr>> finished_;
+    std::unordered_set<std::string> in_flight_;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;
+};
+
+} // end namespace detail
+
+} // end namespace ge211
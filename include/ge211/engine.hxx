@@ -3,6 +3,7 @@
 #include "forward.hxx"
 #include "doxygen.hxx"
 #include "base.hxx"
+#include "hot_reload.hxx"
 #include "render.hxx"
 #include "time.hxx"
 #include "window.hxx"
@@ -20,10 +21,17 @@ public:
     void prepare(const sprites::Sprite&) const;
     Window& get_window() NOEXCEPT;
 
+    size_t drawn_sprite_count() const NOEXCEPT
+    { return drawn_sprites_; }
+
+    size_t culled_sprite_count() const NOEXCEPT
+    { return culled_sprites_; }
+
     ~Engine();
 
 private:
     void handle_events_(SDL_Event&);
+    void wait_pumping_events_(Duration);
     void paint_sprites_(Sprite_set&);
 
     detail::Frame_clock& clock_()
@@ -32,7 +40,12 @@ private:
     Abstract_game& game_;
     Window window_;
     detail::Renderer renderer_;
+    detail::Resource_watcher resource_watcher_;
     bool is_focused_ = false;
+    // Whether SDL's game controller subsystem started.
+    bool has_controllers_;
+    size_t drawn_sprites_ = 0;
+    size_t culled_sprites_ = 0;
 
     struct State_;
 };
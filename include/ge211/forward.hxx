@@ -21,6 +21,8 @@ struct _Mix_Music;
 typedef struct _Mix_Music Mix_Music;
 struct _TTF_Font;
 typedef struct _TTF_Font TTF_Font;
+struct _SDL_GameController;
+typedef struct _SDL_GameController SDL_GameController;
 
 // Forward declarations for all ge211 types.
 namespace ge211 {
@@ -43,11 +45,19 @@ class Audio_clip;
 class Music_track;
 class Sound_effect;
 class Sound_effect_handle;
+class Voice;
 
 } // end namespace audio
 
 namespace events {
 
+enum class Controller_axis;
+enum class Controller_button;
+struct Controller_deadzone;
+class Controller_state;
+struct Input_event;
+enum class Input_mode;
+class Input_state;
 class Key;
 enum class Mouse_button;
 
@@ -79,10 +89,12 @@ class Mixer_not_enabled_error;
 namespace geometry
 {
 
+class Camera;
 class Origin_type;
 template <typename COORDINATE> struct Dims;
 template <typename COORDINATE> struct Posn;
 template <typename COORDINATE> struct Rect;
+template <typename COORDINATE> class Spatial_hash;
 class Transform;
 
 } // end namespace geometry.
@@ -94,8 +106,11 @@ class Sprite;
 class Circle_sprite;
 class Image_sprite;
 class Multiplexed_sprite;
+class Particle_system;
 class Rectangle_sprite;
+class Render_target_sprite;
 class Text_sprite;
+class Tile_map;
 
 } // end namespace sprites
 
@@ -127,13 +142,21 @@ namespace logging {
 /// Internal implementation details.
 namespace detail {
 
+class Controller_tracker;
+class Effect_cache;
 class Engine;
 class File_resource;
+class Font_registry;
 class Frame_clock;
-struct Placed_sprite;
+class Input_tracker;
+class Music_stream;
 class Pausable_timer;
+class Placed_sprites;
 class Renderer;
+class Resource_pack;
+class Resource_watcher;
 class Session;
+class Software_mixer;
 class Texture;
 class Texture_sprite;
 struct Throw_random_source_error;
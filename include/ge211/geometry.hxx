@@ -2,24 +2,35 @@
 
 #include "forward.hxx"
 #include "doxygen.hxx"
+#include "error.hxx"
 #include "util.hxx"
 
 #include <SDL_rect.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <ostream>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+GE211_REGISTER_TYPE_NAME(ge211::Camera);
 GE211_REGISTER_TYPE_NAME(ge211::Origin_type);
 GE211_REGISTER_TYPE_NAME(ge211::Transform);
 
 GE211_REGISTER_TMPL_NAME(ge211::Dims);
 GE211_REGISTER_TMPL_NAME(ge211::Posn);
 GE211_REGISTER_TMPL_NAME(ge211::Rect);
+GE211_REGISTER_TMPL_NAME(ge211::Spatial_hash);
 
 namespace ge211 {
 
 /// Geometric objects and their operations.
+///
+/// Dims, Posn, Rect and most of Transform are `constexpr`, so tables
+/// of layouts or offsets built from them can be computed at compile
+/// time.
 namespace geometry {
 
 /// The type of the special value @ref the_origin.
@@ -48,12 +59,12 @@ struct Dims
     /// @{
 
     /// Constructs a dimensions from the given *width* and *height*.
-    Dims(Coordinate width, Coordinate height)
+    constexpr Dims(Coordinate width, Coordinate height)
             : width{width},
               height{height} { }
 
     /// Default-constructs the zero-sized Dims.
-    Dims()
+    constexpr Dims()
             : Dims{Coordinate{}, Coordinate{}} { }
 
     /// Casts or converts a @ref Dims to a Dims of a different coordinate type.
@@ -64,7 +75,7 @@ struct Dims
     /// auto p2 = ge211::Dims<double>(p1);
     /// ```
     template <typename FROM_COORD>
-    explicit Dims(const Dims<FROM_COORD>& that)
+    explicit constexpr Dims(const Dims<FROM_COORD>& that)
             : width(that.width),
               height(that.height) { }
 
@@ -77,7 +88,7 @@ struct Dims
     /// auto d2 = d1.into<double>();
     /// ```
     template <typename TO_COORD>
-    ge211::Dims<TO_COORD>
+    constexpr ge211::Dims<TO_COORD>
     into() const
     {
         return {TO_COORD(width), TO_COORD(height)};
@@ -89,54 +100,54 @@ struct Dims
     /// @{
 
     /// Equality for Dims.
-    bool operator==(Dims that) const
+    constexpr bool operator==(Dims that) const
     {
         return width == that.width && height == that.height;
     }
 
     /// Disquality for Dims.
-    bool operator!=(Dims that) const
+    constexpr bool operator!=(Dims that) const
     {
         return !operator==(that);
     }
 
     /// Less-than-or-equal for Dims. Determines whether some Dims
     /// fits inside another Dims.
-    bool operator<=(Dims that) const
+    constexpr bool operator<=(Dims that) const
     {
         return width <= that.width && height <= that.height;
     }
 
     /// Greater-than-or-equal for Dims. Determines whether some Dims
     /// fits inside some other Dims.
-    bool operator>=(Dims that) const
+    constexpr bool operator>=(Dims that) const
     {
         return that <= *this;
     }
 
     /// Less-than for Dims. True when some Dims fits inside another Dims
     /// but they aren't equal.
-    bool operator<(Dims that) const
+    constexpr bool operator<(Dims that) const
     {
         return *this <= that && *this != that;
     }
 
     /// Greater-than for Dims. True when some Dims fits inside some other Dims
     /// but they aren't equal.
-    bool operator>(Dims that) const
+    constexpr bool operator>(Dims that) const
     {
         return that < *this;
     }
 
     /// Adds two Dims%es. This is vector addition.
-    Dims operator+(Dims that) const
+    constexpr Dims operator+(Dims that) const
     {
         return {Coordinate(width + that.width),
                 Coordinate(height + that.height)};
     }
 
     /// Subtracts two Dims%es. This is vector subtraction.
-    Dims operator-(Dims that) const
+    constexpr Dims operator-(Dims that) const
     {
         return {Coordinate(width - that.width),
                 Coordinate(height - that.height)};
@@ -157,7 +168,7 @@ struct Dims
     /// CHECK( actual_result == expected_result );
     /// ```
     template <typename RHS_COORD>
-    auto operator*(Dims<RHS_COORD> that) const
+    constexpr auto operator*(Dims<RHS_COORD> that) const
     {
         using A = Coordinate;
         using B = RHS_COORD;
@@ -170,7 +181,7 @@ struct Dims
             typename SCALAR,
             typename = std::enable_if_t<std::is_scalar<SCALAR>{}>
     >
-    Dims operator*(SCALAR that) const
+    constexpr Dims operator*(SCALAR that) const
     {
         return {Coordinate(width * that), Coordinate(height * that)};
     }
@@ -180,26 +191,26 @@ struct Dims
             typename SCALAR,
             typename = std::enable_if_t<std::is_scalar<SCALAR>{}>
     >
-    Dims operator/(SCALAR that) const
+    constexpr Dims operator/(SCALAR that) const
     {
         return {Coordinate(width / that), Coordinate(height / that)};
     }
 
     // Negates a Dims. (Multiplies it by -1.)
-    Dims
+    constexpr Dims
     operator-() const
     {
         return {-width, -height};
     }
 
     /// Succinct Dims addition.
-    Dims& operator+=(Dims that)
+    constexpr Dims& operator+=(Dims that)
     {
         return *this = *this + that;
     }
 
     /// Succinct Dims subtraction.
-    Dims& operator-=(Dims that)
+    constexpr Dims& operator-=(Dims that)
     {
         return *this = *this - that;
     }
@@ -221,7 +232,7 @@ struct Dims
             typename SCALAR,
             typename = std::enable_if_t<std::is_scalar<SCALAR>{}>
     >
-    Dims& operator*=(SCALAR that)
+    constexpr Dims& operator*=(SCALAR that)
     {
         return *this = *this * that;
     }
@@ -236,7 +247,7 @@ struct Dims
             typename SCALAR,
             typename = std::enable_if_t<std::is_scalar<SCALAR>{}>
     >
-    Dims& operator/=(SCALAR that)
+    constexpr Dims& operator/=(SCALAR that)
     {
         return *this = *this / that;
     }
@@ -251,7 +262,7 @@ template <
         typename DIMS_COORD,
         typename = std::enable_if_t<std::is_scalar<SCALAR>{}>
 >
-Dims<DIMS_COORD>
+constexpr Dims<DIMS_COORD>
 operator*(SCALAR a, Dims<DIMS_COORD> b)
 {
     return b * a;
@@ -279,17 +290,17 @@ struct Posn
     /// @{
 
     /// Constructs a position from the given *x* and *y* coordinates.
-    Posn(Coordinate x, Coordinate y)
+    constexpr Posn(Coordinate x, Coordinate y)
             : x{x},
               y{y} { }
 
     /// Constructs the origin when given @ref the_origin.
-    Posn(Origin_type)
+    constexpr Posn(Origin_type)
             : Posn(Coordinate{}, Coordinate{}) { }
 
     /// Constructs a position from a Dims, which gives the
     /// displacement of the position from the origin.
-    explicit Posn(Dims_type dims)
+    explicit constexpr Posn(Dims_type dims)
             : Posn{dims.width, dims.height} { }
 
     /// Casts or converts a @ref Posn to a Posn of a different coordinate type.
@@ -300,7 +311,7 @@ struct Posn
     /// auto p2 = ge211::Posn<double>(p1);
     /// ```
     template <typename FROM_COORD>
-    explicit Posn(const Posn<FROM_COORD>& that)
+    explicit constexpr Posn(const Posn<FROM_COORD>& that)
             : x(that.x),
               y(that.y) { }
 
@@ -313,7 +324,7 @@ struct Posn
     /// auto p2 = p1.into<double>();
     /// ```
     template <typename TO_COORD>
-    ge211::Posn<TO_COORD>
+    constexpr ge211::Posn<TO_COORD>
     into() const
     {
         return {TO_COORD(x), TO_COORD(y)};
@@ -325,45 +336,45 @@ struct Posn
     /// @{
 
     /// Equality for positions.
-    bool operator==(Posn that) const
+    constexpr bool operator==(Posn that) const
     {
         return x == that.x && y == that.y;
     }
 
     /// Disequality for positions.
-    bool operator!=(Posn that) const
+    constexpr bool operator!=(Posn that) const
     {
         return x != that.x || y != that.y;
     }
 
     /// Translates a position by some displacement. This is the same as
     /// @ref Posn::down_right_by(Dims_type) const.
-    Posn operator+(Dims_type that) const
+    constexpr Posn operator+(Dims_type that) const
     {
         return down_right_by(that);
     }
 
     /// Translates a position by the opposite of some displacement. This is
     /// the same as @ref Posn::up_left_by(Dims_type) const.
-    Posn operator-(Dims_type that) const
+    constexpr Posn operator-(Dims_type that) const
     {
         return up_left_by(that);
     }
 
     /// Subtracts two Posn%s, yields a Dims.
-    Dims_type operator-(Posn that) const
+    constexpr Dims_type operator-(Posn that) const
     {
         return {x - that.x, y - that.y};
     }
 
     /// Succinct position translation.
-    Posn& operator+=(Dims_type that)
+    constexpr Posn& operator+=(Dims_type that)
     {
         return *this = *this + that;
     }
 
     /// Succinct position translation.
-    Posn& operator-=(Dims_type that)
+    constexpr Posn& operator-=(Dims_type that)
     {
         return *this = *this - that;
     }
@@ -375,56 +386,56 @@ struct Posn
 
     /// Constructs the position that is above this position by the given
     /// amount.
-    Posn up_by(Coordinate dy) const
+    constexpr Posn up_by(Coordinate dy) const
     {
         return {x, y - dy};
     }
 
     /// Constructs the position that is below this position by the given
     /// amount.
-    Posn down_by(Coordinate dy) const
+    constexpr Posn down_by(Coordinate dy) const
     {
         return {x, y + dy};
     }
 
     /// Constructs the position that is to the left of this position by
     /// the given amount.
-    Posn left_by(Coordinate dx) const
+    constexpr Posn left_by(Coordinate dx) const
     {
         return {x - dx, y};
     }
 
     /// Constructs the position that is to the right of this position by
     /// the given amount.
-    Posn right_by(Coordinate dx) const
+    constexpr Posn right_by(Coordinate dx) const
     {
         return {x + dx, y};
     }
 
     /// Constructs the position that is above and left of this position
     /// by the given dimensions.
-    Posn up_left_by(Dims_type dims) const
+    constexpr Posn up_left_by(Dims_type dims) const
     {
         return {x - dims.width, y - dims.height};
     }
 
     /// Constructs the position that is above and right of this position
     /// by the given dimensions.
-    Posn up_right_by(Dims_type dims) const
+    constexpr Posn up_right_by(Dims_type dims) const
     {
         return {x + dims.width, y - dims.height};
     }
 
     /// Constructs the position that is below and left of this position
     /// by the given dimensions.
-    Posn down_left_by(Dims_type dims) const
+    constexpr Posn down_left_by(Dims_type dims) const
     {
         return {x - dims.width, y + dims.height};
     }
 
     /// Constructs the position that is below and right of this position
     /// by the given dimensions.
-    Posn down_right_by(Dims_type dims) const
+    constexpr Posn down_right_by(Dims_type dims) const
     {
         return {x + dims.width, y + dims.height};
     }
@@ -459,14 +470,15 @@ struct Rect
 
     /// Constructs a rectangle given the *x* and *y* coordinates of its
     /// top left corner, and its width and height.
-    Rect(Coordinate x, Coordinate y, Coordinate width, Coordinate height)
+    constexpr Rect(Coordinate x, Coordinate y,
+                   Coordinate width, Coordinate height)
             : x{x},
               y{y},
               width{width},
               height{height} { }
 
     /// Default-constructs the zero-sized Rect at the origin.
-    Rect()
+    constexpr Rect()
             : Rect{Coordinate{}, Coordinate{}, Coordinate{}, Coordinate{}} { }
 
     /// Casts or converts a @ref Rect to a Rect of a different coordinate type.
@@ -477,7 +489,7 @@ struct Rect
     /// auto p2 = ge211::Posn<double>(p1);
     /// ```
     template <typename FROM_COORD>
-    explicit Rect(const Rect<FROM_COORD>& that)
+    explicit constexpr Rect(const Rect<FROM_COORD>& that)
             : x(that.x),
               y(that.y),
               width(that.width),
@@ -492,7 +504,7 @@ struct Rect
     /// auto r2 = r1.into<double>();
     /// ```
     template <typename TO_COORD>
-    ge211::Rect<TO_COORD>
+    constexpr ge211::Rect<TO_COORD>
     into() const
     {
         return {TO_COORD(x), TO_COORD(y), TO_COORD(width), TO_COORD(height)};
@@ -505,7 +517,7 @@ struct Rect
 
     /// Equality for rectangles. Note that this is naïve, in that it considers
     /// empty rectangles with different positions to be different.
-    bool operator==(Rect that) const
+    constexpr bool operator==(Rect that) const
     {
         return x == that.x &&
                y == that.y &&
@@ -514,7 +526,7 @@ struct Rect
     }
 
     /// Disequality for rectangles.
-    bool operator!=(Rect that) const
+    constexpr bool operator!=(Rect that) const
     {
         return !operator==(that);
     }
@@ -526,37 +538,37 @@ struct Rect
 
     /// The dimensions of the rectangle. Equivalent to
     /// `Dims<Coordinate>{rect.width, rect.height}`.
-    Dims_type dimensions() const
+    constexpr Dims_type dimensions() const
     {
         return {width, height};
     }
 
     /// The position of the top left vertex.
-    Posn_type top_left() const
+    constexpr Posn_type top_left() const
     {
         return {x, y};
     }
 
     /// The position of the top right vertex.
-    Posn_type top_right() const
+    constexpr Posn_type top_right() const
     {
         return top_left().right_by(width);
     }
 
     /// The position of the bottom left vertex.
-    Posn_type bottom_left() const
+    constexpr Posn_type bottom_left() const
     {
         return top_left().down_by(height);
     }
 
     /// The position of the bottom right vertex.
-    Posn_type bottom_right() const
+    constexpr Posn_type bottom_right() const
     {
         return top_left().down_right_by(dimensions());
     }
 
     /// The position of the center of the rectangle.
-    Posn_type center() const
+    constexpr Posn_type center() const
     {
         return top_left().down_right_by(dimensions() / Coordinate(2));
     }
@@ -568,35 +580,35 @@ struct Rect
 
     /// Creates a Rect given the position of its top left vertex
     /// and its dimensions.
-    static Rect from_top_left(Posn_type tl, Dims_type dims)
+    static constexpr Rect from_top_left(Posn_type tl, Dims_type dims)
     {
         return {tl.x, tl.y, dims.width, dims.height};
     }
 
     /// Creates a Rect given the position of its top right vertex
     /// and its dimensions.
-    static Rect from_top_right(Posn_type tr, Dims_type dims)
+    static constexpr Rect from_top_right(Posn_type tr, Dims_type dims)
     {
         return from_top_left(tr.left_by(dims.width), dims);
     }
 
     /// Creates a Rect given the position of its bottom left vertex
     /// and its dimensions.
-    static Rect from_bottom_left(Posn_type bl, Dims_type dims)
+    static constexpr Rect from_bottom_left(Posn_type bl, Dims_type dims)
     {
         return from_top_left(bl.up_by(dims.height), dims);
     }
 
     /// Creates a Rect given the position of its bottom right vertex
     /// and its dimensions.
-    static Rect from_bottom_right(Posn_type br, Dims_type dims)
+    static constexpr Rect from_bottom_right(Posn_type br, Dims_type dims)
     {
         return from_top_left(br.up_left_by(dims), dims);
     }
 
     /// Creates a Rect given the position of its center
     /// and its dimensions.
-    static Rect from_center(Posn_type center, Dims_type dims)
+    static constexpr Rect from_center(Posn_type center, Dims_type dims)
     {
         return from_top_left(center.up_left_by(dims / Coordinate(2)), dims);
     }
@@ -609,6 +621,7 @@ struct Rect
 #endif
 
     class iterator;
+    class row_iterator;
 
 #pragma GCC diagnostic pop
 
@@ -624,6 +637,56 @@ struct Rect
         return {top_left().right_by(width), y, y + height};
     }
 
+    /// One row of the positions in a rectangle: those with *y*
+    /// coordinate `y` and *x* coordinates from `x_begin` up to but not
+    /// including `x_end`.
+    struct Row_span
+    {
+        Coordinate y;        ///< The *y* coordinate of the row.
+        Coordinate x_begin;  ///< The first *x* coordinate in the row.
+        Coordinate x_end;    ///< One past the last *x* coordinate.
+    };
+
+    class Row_range;
+
+    /// Returns the rows of this rectangle, from top to bottom, for
+    /// visiting its positions in row-major order. This is the order
+    /// that grids stored row by row are laid out in memory, so it is
+    /// much kinder to the cache than iterating over the Rect itself,
+    /// which goes column by column. For example:
+    ///
+    /// ```
+    /// for (auto row : rect.rows()) {
+    ///     int* cell = &grid[row.y * grid_width];
+    ///     std::fill(cell + row.x_begin, cell + row.x_end, 0);
+    /// }
+    /// ```
+    Row_range rows() const
+    {
+        return Row_range({y, x, x + width}, height > 0 ? y + height : y);
+    }
+
+    /// Calls `f` with each position of this rectangle, as a `Posn_type`,
+    /// in row-major order. The loops are simple enough that when `f`
+    /// can be inlined, the compiler is free to vectorize across each
+    /// row. For example:
+    ///
+    /// ```
+    /// rect.for_each_posn([&](ge211::Posn<int> p) {
+    ///     grid[p.y * grid_width + p.x] += 1;
+    /// });
+    /// ```
+    template <typename FUNCTION>
+    void for_each_posn(FUNCTION f) const
+    {
+        Coordinate x_end = x + width;
+        Coordinate y_end = y + height;
+
+        for (Coordinate row = y; row < y_end; ++row)
+            for (Coordinate col = x; col < x_end; ++col)
+                f(Posn_type{col, row});
+    }
+
 private:
     friend Circle_sprite;
     friend ::ge211::internal::Render_sprite;
@@ -644,7 +707,8 @@ private:
 
 /// An iterator over the `Posn<COORDINATE>`s of a `Rect<COORDINATE>`.
 ///
-/// Iterates in column-major order.
+/// Iterates in column-major order. For row-major order, use
+/// Rect::rows() or Rect::for_each_posn().
 template <typename COORDINATE>
 class Rect<COORDINATE>::iterator
         : public std::iterator<std::input_iterator_tag, const Posn_type>
@@ -728,6 +792,521 @@ private:
     Coordinate y_end_;
 };
 
+/// An iterator over the rows of a `Rect<COORDINATE>`, as returned by
+/// Rect::rows().
+template <typename COORDINATE>
+class Rect<COORDINATE>::row_iterator
+        : public std::iterator<std::input_iterator_tag, const Row_span>
+{
+public:
+    /// Returns the current row of this iterator.
+    Row_span operator*() const
+    {
+        return current_;
+    }
+
+    /// Returns a pointer to the current row of this iterator.
+    Row_span const *operator->() const
+    {
+        return &current_;
+    }
+
+    /// Pre-increments, advancing this iterator to the next row.
+    row_iterator& operator++()
+    {
+        ++current_.y;
+        return *this;
+    }
+
+    /// Post-increments, advancing this iterator to the next row.
+    row_iterator operator++(int)
+    {
+        row_iterator result(*this);
+        ++*this;
+        return result;
+    }
+
+    /// Compares whether two iterators are equal. Considers only the
+    /// current row's *y* coordinate.
+    bool operator==(row_iterator that) const
+    {
+        return current_.y == that.current_.y;
+    }
+
+    /// Iterator inequality.
+    bool operator!=(row_iterator that) const
+    {
+        return !operator==(that);
+    }
+
+private:
+    friend Row_range;
+
+    explicit row_iterator(Row_span current)
+            : current_(current) { }
+
+    Row_span current_;
+};
+
+/// The rows of a `Rect<COORDINATE>`, as returned by Rect::rows(), for
+/// use with range-based `for`.
+template <typename COORDINATE>
+class Rect<COORDINATE>::Row_range
+{
+public:
+    /// Returns an iterator to the top row.
+    row_iterator begin() const
+    {
+        return row_iterator(first_);
+    }
+
+    /// Returns an iterator one past the bottom row.
+    row_iterator end() const
+    {
+        return row_iterator({y_end_, first_.x_begin, first_.x_end});
+    }
+
+private:
+    friend Rect;
+
+    Row_range(Row_span first, Coordinate y_end)
+            : first_(first),
+              y_end_(y_end) { }
+
+    Row_span first_;
+    Coordinate y_end_;
+};
+
+/// A uniform spatial hash over objects with `Rect<COORDINATE>` bounds,
+/// for quickly finding the objects in an area or near a point. This
+/// makes a good broad phase for collision detection: rather than
+/// testing every pair of objects, query each object's bounds and test
+/// only the objects returned.
+///
+/// The plane is divided into square cells, and each object is recorded
+/// in every cell its bounds touch. Choose a cell size around the size of
+/// a typical object: with cells much smaller, large objects touch many
+/// cells; with cells much larger, queries return many far-off objects.
+///
+/// Objects are identified by the @ref Handle returned by insert(),
+/// which remains valid until the object is removed. Handles of removed
+/// objects are reused, so it's cheapest to keep the handle in the game
+/// object and keep the game objects in a container indexed by handle.
+///
+/// Bounds are treated as closed, so objects whose bounds merely touch
+/// are reported as overlapping, and zero-sized bounds work as points.
+///
+/// For example:
+///
+/// ```
+/// ge211::Spatial_hash<double> grid(64);
+///
+/// for (Ball& ball : balls)
+///     ball.handle = grid.insert(ball.bounds());
+///
+/// // each frame:
+/// for (Ball& ball : balls)
+///     grid.update(ball.handle, ball.bounds());
+///
+/// for (Ball& ball : balls)
+///     grid.query(ball.bounds(), [&](auto other) {
+///         if (other != ball.handle) ball.check_collision(balls[other]);
+///     });
+/// ```
+template <typename COORDINATE>
+class Spatial_hash
+{
+public:
+    /// The coordinate type. This is an alias of type parameter
+    /// `COORDINATE`.
+    using Coordinate = COORDINATE;
+
+    /// The bounds type, @ref ge211::geometry::Rect.
+    using Rect_type = Rect<Coordinate>;
+
+    /// The position type, @ref ge211::geometry::Posn.
+    using Posn_type = Posn<Coordinate>;
+
+    /// Identifies an object in the spatial hash.
+    using Handle = std::uint32_t;
+
+    /// Constructs an empty spatial hash with the given cell size.
+    ///
+    /// \preconditions
+    ///  - `cell_size` is positive; throws exceptions::Client_logic_error
+    ///    otherwise.
+    explicit Spatial_hash(Coordinate cell_size)
+            : cell_size_(cell_size)
+    {
+        if (!(cell_size > Coordinate(0)))
+            throw Client_logic_error("Spatial_hash: cell size must be "
+                                     "positive");
+
+        cells_.resize(min_cells_);
+    }
+
+    /// \name Modifying the contents
+    /// @{
+
+    /// Adds an object with the given bounds, returning its handle.
+    Handle insert(Rect_type bounds)
+    {
+        Handle handle;
+
+        if (free_entries_.empty()) {
+            handle = Handle(entries_.size());
+            entries_.emplace_back();
+        } else {
+            handle = free_entries_.back();
+            free_entries_.pop_back();
+        }
+
+        Entry_& entry = entries_[handle];
+        entry.bounds = bounds;
+        entry.cells  = cells_of_(bounds);
+        entry.live   = true;
+        link_(handle, entry.cells);
+
+        ++size_;
+        return handle;
+    }
+
+    /// Changes the bounds of an object. This is cheap when the object
+    /// stays within the same cells.
+    ///
+    /// \preconditions
+    ///  - `handle` was returned by insert() and hasn't been removed.
+    void update(Handle handle, Rect_type bounds)
+    {
+        Entry_& entry = entries_[handle];
+        Cell_range_ cells = cells_of_(bounds);
+
+        entry.bounds = bounds;
+        if (cells == entry.cells) return;
+
+        unlink_(handle, entry.cells);
+        entry.cells = cells;
+        link_(handle, cells);
+    }
+
+    /// Removes an object. Its handle may be returned by a later insert().
+    ///
+    /// \preconditions
+    ///  - `handle` was returned by insert() and hasn't been removed.
+    void remove(Handle handle)
+    {
+        Entry_& entry = entries_[handle];
+        unlink_(handle, entry.cells);
+        entry.live = false;
+        free_entries_.push_back(handle);
+        --size_;
+    }
+
+    /// Removes all objects, keeping the memory allocated for them.
+    void clear() NOEXCEPT
+    {
+        entries_.clear();
+        free_entries_.clear();
+        nodes_.clear();
+        free_node_ = none_;
+        std::fill(cells_.begin(), cells_.end(), Cell_{});
+        used_cells_ = 0;
+        size_ = 0;
+    }
+
+    /// @}
+
+    /// \name Observers
+    /// @{
+
+    /// The bounds of an object.
+    ///
+    /// \preconditions
+    ///  - `handle` was returned by insert() and hasn't been removed.
+    Rect_type bounds(Handle handle) const
+    {
+        return entries_[handle].bounds;
+    }
+
+    /// The number of objects.
+    size_t size() const NOEXCEPT
+    {
+        return size_;
+    }
+
+    /// Are there no objects?
+    bool empty() const NOEXCEPT
+    {
+        return size_ == 0;
+    }
+
+    /// The cell size given to the constructor.
+    Coordinate cell_size() const NOEXCEPT
+    {
+        return cell_size_;
+    }
+
+    /// @}
+
+    /// \name Queries
+    ///
+    /// These call a visitor function with the Handle of each object
+    /// found, once per object, in no particular order. They don't
+    /// allocate memory. The visitor must not modify the spatial hash.
+    ///
+    /// @{
+
+    /// Visits each object whose bounds overlap `area`.
+    template <typename VISITOR>
+    void query(Rect_type area, VISITOR&& visit) const
+    {
+        query_(cells_of_(area), area, [&](Handle handle) {
+            if (overlap_(entries_[handle].bounds, area)) visit(handle);
+        });
+    }
+
+    /// Visits each object whose bounds come within `radius` of `center`.
+    template <typename VISITOR>
+    void query(Posn_type center, Coordinate radius, VISITOR&& visit) const
+    {
+        Rect_type square{center.x - radius, center.y - radius,
+                         radius + radius, radius + radius};
+        double limit = double(radius) * double(radius);
+
+        query_(cells_of_(square), square, [&](Handle handle) {
+            Rect_type const& b = entries_[handle].bounds;
+            double dx = gap_(double(center.x), double(b.x),
+                             double(b.x + b.width));
+            double dy = gap_(double(center.y), double(b.y),
+                             double(b.y + b.height));
+            if (dx * dx + dy * dy <= limit) visit(handle);
+        });
+    }
+
+    /// @}
+
+private:
+    static constexpr std::uint32_t none_ = ~std::uint32_t(0);
+    static constexpr size_t min_cells_ = 64;
+
+    // An inclusive range of cell coordinates.
+    struct Cell_range_
+    {
+        int x0, y0, x1, y1;
+
+        bool operator==(Cell_range_ const& that) const
+        {
+            return x0 == that.x0 && y0 == that.y0 &&
+                   x1 == that.x1 && y1 == that.y1;
+        }
+    };
+
+    struct Entry_
+    {
+        Rect_type bounds;
+        Cell_range_ cells;
+        bool live;
+    };
+
+    // An object's membership in one cell. Each cell's nodes form a
+    // singly-linked list, and all lists share one array.
+    struct Node_
+    {
+        Handle object;
+        std::uint32_t next;
+    };
+
+    // A slot in the open-addressed table of cells. A slot, once used,
+    // keeps its cell even when the cell empties, until the next rehash.
+    struct Cell_
+    {
+        int x = 0;
+        int y = 0;
+        std::uint32_t head = none_;
+        bool used = false;
+    };
+
+    int cell_of_(Coordinate c) const
+    {
+        return int(std::floor(double(c) / double(cell_size_)));
+    }
+
+    Cell_range_ cells_of_(Rect_type const& r) const
+    {
+        return {cell_of_(r.x), cell_of_(r.y),
+                cell_of_(r.x + r.width), cell_of_(r.y + r.height)};
+    }
+
+    static bool overlap_(Rect_type const& a, Rect_type const& b)
+    {
+        return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+               a.y <= b.y + b.height && b.y <= a.y + a.height;
+    }
+
+    // The distance from `c` to the interval [lo, hi].
+    static double gap_(double c, double lo, double hi)
+    {
+        return c < lo ? lo - c : c > hi ? c - hi : 0;
+    }
+
+    size_t slot_of_(int x, int y) const
+    {
+        std::uint32_t h = std::uint32_t(x) * 0x9E3779B1u ^
+                          std::uint32_t(y) * 0x85EBCA77u;
+        h ^= h >> 15;
+        return h & (cells_.size() - 1);
+    }
+
+    // Finds the slot for a cell, or an unused slot where it would go.
+    size_t find_slot_(int x, int y) const
+    {
+        size_t mask = cells_.size() - 1;
+        size_t slot = slot_of_(x, y);
+
+        while (cells_[slot].used &&
+               (cells_[slot].x != x || cells_[slot].y != y))
+            slot = (slot + 1) & mask;
+
+        return slot;
+    }
+
+    std::uint32_t new_node_(Handle object, std::uint32_t next)
+    {
+        std::uint32_t index;
+
+        if (free_node_ == none_) {
+            index = std::uint32_t(nodes_.size());
+            nodes_.push_back({object, next});
+        } else {
+            index = free_node_;
+            free_node_ = nodes_[index].next;
+            nodes_[index] = {object, next};
+        }
+
+        return index;
+    }
+
+    void link_(Handle handle, Cell_range_ const& range)
+    {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            for (int y = range.y0; y <= range.y1; ++y) {
+                size_t slot = find_slot_(x, y);
+                Cell_* cell = &cells_[slot];
+
+                if (!cell->used) {
+                    // Keep the load factor at most one half.
+                    if (2 * (used_cells_ + 1) > cells_.size()) {
+                        rehash_();
+                        cell = &cells_[find_slot_(x, y)];
+                    }
+
+                    cell->x = x;
+                    cell->y = y;
+                    cell->used = true;
+                    ++used_cells_;
+                }
+
+                cell->head = new_node_(handle, cell->head);
+            }
+        }
+    }
+
+    void unlink_(Handle handle, Cell_range_ const& range)
+    {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            for (int y = range.y0; y <= range.y1; ++y) {
+                std::uint32_t* link = &cells_[find_slot_(x, y)].head;
+
+                while (nodes_[*link].object != handle)
+                    link = &nodes_[*link].next;
+
+                std::uint32_t node = *link;
+                *link = nodes_[node].next;
+                nodes_[node].next = free_node_;
+                free_node_ = node;
+            }
+        }
+    }
+
+    // Rebuilds the table without the empty cells, growing it if it
+    // would still be more than a quarter full.
+    void rehash_()
+    {
+        size_t live = 0;
+        for (Cell_ const& cell : cells_)
+            if (cell.head != none_) ++live;
+
+        size_t capacity = min_cells_;
+        while (capacity < 4 * (live + 1)) capacity *= 2;
+
+        std::vector<Cell_> old(capacity);
+        old.swap(cells_);
+        used_cells_ = 0;
+
+        for (Cell_ const& cell : old) {
+            if (cell.head == none_) continue;
+            cells_[find_slot_(cell.x, cell.y)] = cell;
+            ++used_cells_;
+        }
+    }
+
+    // Calls `visit` for each object in the cells in `range`, once per
+    // object. An object that spans several of the cells is visited only
+    // from the cell holding the top-left corner of its overlap with
+    // `area`.
+    template <typename VISITOR>
+    void query_(Cell_range_ const& range, Rect_type const& area,
+                VISITOR&& visit) const
+    {
+        auto visit_cell = [&](Cell_ const& cell) {
+            for (std::uint32_t n = cell.head; n != none_; n = nodes_[n].next) {
+                Handle handle = nodes_[n].object;
+                Rect_type const& b = entries_[handle].bounds;
+                if (cell_of_(std::max(b.x, area.x)) == cell.x &&
+                    cell_of_(std::max(b.y, area.y)) == cell.y)
+                    visit(handle);
+            }
+        };
+
+        double span = (double(range.x1) - range.x0 + 1) *
+                      (double(range.y1) - range.y0 + 1);
+
+        // For an area bigger than the table, it's quicker to scan the
+        // table than to look up every cell.
+        if (span > double(cells_.size())) {
+            for (Cell_ const& cell : cells_) {
+                if (cell.head != none_ &&
+                    range.x0 <= cell.x && cell.x <= range.x1 &&
+                    range.y0 <= cell.y && cell.y <= range.y1)
+                    visit_cell(cell);
+            }
+            return;
+        }
+
+        for (int x = range.x0; x <= range.x1; ++x) {
+            for (int y = range.y0; y <= range.y1; ++y) {
+                Cell_ const& cell = cells_[find_slot_(x, y)];
+                if (cell.used) visit_cell(cell);
+            }
+        }
+    }
+
+    Coordinate cell_size_;
+    std::vector<Entry_> entries_;
+    std::vector<Handle> free_entries_;
+    std::vector<Node_> nodes_;
+    std::uint32_t free_node_ = none_;
+    std::vector<Cell_> cells_;
+    size_t used_cells_ = 0;
+    size_t size_ = 0;
+};
+
+template <typename COORDINATE>
+constexpr std::uint32_t Spatial_hash<COORDINATE>::none_;
+
+template <typename COORDINATE>
+constexpr size_t Spatial_hash<COORDINATE>::min_cells_;
+
 /// A rendering transformation, which can scale, flip, and rotate.
 /// A Transform can be given to
 /// Sprite_set::add_sprite(const Sprite&, Posn<int>, int, const Transform&)
@@ -762,26 +1341,47 @@ public:
     /// @{
 
     /// Constructs the identity transform, which has no effect.
-    Transform() NOEXCEPT;
+    constexpr Transform() NOEXCEPT
+            : rotation_{0},
+              scale_x_{1.0},
+              scale_y_{1.0},
+              flip_h_{false},
+              flip_v_{false}
+    { }
 
     /// Constructs a rotating transform, given the rotation in degrees
     /// clockwise.
     static Transform rotation(double) NOEXCEPT;
 
     /// Constructs a transform that flips the sprite horizontally.
-    static Transform flip_h() NOEXCEPT;
+    static constexpr Transform flip_h() NOEXCEPT
+    {
+        return Transform().set_flip_h(true);
+    }
 
     /// Constructs a transform that flips the sprite vertically.
-    static Transform flip_v() NOEXCEPT;
+    static constexpr Transform flip_v() NOEXCEPT
+    {
+        return Transform().set_flip_v(true);
+    }
 
     /// Constructs a transform that scales the sprite in both dimensions.
-    static Transform scale(double) NOEXCEPT;
+    static constexpr Transform scale(double factor) NOEXCEPT
+    {
+        return Transform().set_scale(factor);
+    }
 
     /// Constructs a transform that scales the sprite in the *x* dimension.
-    static Transform scale_x(double) NOEXCEPT;
+    static constexpr Transform scale_x(double factor) NOEXCEPT
+    {
+        return Transform().set_scale_x(factor);
+    }
 
     /// Constructs a transform that scales the sprite in the *y* dimension.
-    static Transform scale_y(double) NOEXCEPT;
+    static constexpr Transform scale_y(double factor) NOEXCEPT
+    {
+        return Transform().set_scale_y(factor);
+    }
 
     /// @}
 
@@ -792,25 +1392,46 @@ public:
     Transform& set_rotation(double) NOEXCEPT;
 
     /// Modifies this transform to determine whether to flip horizontally.
-    Transform& set_flip_h(bool) NOEXCEPT;
+    constexpr Transform& set_flip_h(bool flip_h) NOEXCEPT
+    {
+        flip_h_ = flip_h;
+        return *this;
+    }
 
     /// Modifies this transform to determine whether to flip vertically.
-    Transform& set_flip_v(bool) NOEXCEPT;
+    constexpr Transform& set_flip_v(bool flip_v) NOEXCEPT
+    {
+        flip_v_ = flip_v;
+        return *this;
+    }
 
     /// Modifies this transform to scale the sprite by the given amount in
     /// both dimensions. This overwrites the effect of previous calls to
     /// set_scale_x(double) and set_scale_y(double).
-    Transform& set_scale(double) NOEXCEPT;
+    constexpr Transform& set_scale(double scale) NOEXCEPT
+    {
+        scale_x_ = scale;
+        scale_y_ = scale;
+        return *this;
+    }
 
     /// Modifies this transform to scale the sprite horizontally. This
     /// overwrites the effect of previous calls to `set_scale(double)`
     /// as well as itself.
-    Transform& set_scale_x(double) NOEXCEPT;
+    constexpr Transform& set_scale_x(double scale_x) NOEXCEPT
+    {
+        scale_x_ = scale_x;
+        return *this;
+    }
 
     /// Modifies this transform to scale the sprite vertically. This
     /// overwrites the effect of previous calls to `set_scale(double)`
     /// as well as itself.
-    Transform& set_scale_y(double) NOEXCEPT;
+    constexpr Transform& set_scale_y(double scale_y) NOEXCEPT
+    {
+        scale_y_ = scale_y;
+        return *this;
+    }
 
     /// @}
 
@@ -818,19 +1439,24 @@ public:
     /// @{
 
     /// Returns the rotation that will be applied to the sprite.
-    double get_rotation() const NOEXCEPT;
+    constexpr double get_rotation() const NOEXCEPT
+    { return rotation_; }
 
     /// Returns whether the sprite will be flipped horizontally.
-    bool get_flip_h() const NOEXCEPT;
+    constexpr bool get_flip_h() const NOEXCEPT
+    { return flip_h_; }
 
     /// Returns whether the sprite will be flipped vertically.
-    bool get_flip_v() const NOEXCEPT;
+    constexpr bool get_flip_v() const NOEXCEPT
+    { return flip_v_; }
 
     /// Returns how much the sprite will be scaled horizontally.
-    double get_scale_x() const NOEXCEPT;
+    constexpr double get_scale_x() const NOEXCEPT
+    { return scale_x_; }
 
     /// Returns how much the sprite will be scaled vertically.
-    double get_scale_y() const NOEXCEPT;
+    constexpr double get_scale_y() const NOEXCEPT
+    { return scale_y_; }
 
     /// @}
 
@@ -841,7 +1467,10 @@ public:
     /// Because floating point is approximate, this may answer `false` for
     /// transforms that are nearly the identity. But it should answer `true`
     /// for any transform constructed by the default constructor Transform().
-    bool is_identity() const NOEXCEPT;
+    constexpr bool is_identity() const NOEXCEPT
+    {
+        return *this == Transform();
+    }
 
     /// Returns the inverse of this transform. Composing a transform with its
     /// inverse should result in the identity transformation, though because
@@ -858,10 +1487,20 @@ public:
     /// @{
 
     /// Equality for `Transform`s.
-    bool operator==(Transform const&) const NOEXCEPT;
+    constexpr bool operator==(Transform const& that) const NOEXCEPT
+    {
+        return rotation_ == that.rotation_ &&
+               flip_h_ == that.flip_h_ &&
+               flip_v_ == that.flip_v_ &&
+               scale_x_ == that.scale_x_ &&
+               scale_y_ == that.scale_y_;
+    }
 
     /// Disequality for `Transform`s.
-    bool operator!=(Transform const&) const NOEXCEPT;
+    constexpr bool operator!=(Transform const& that) const NOEXCEPT
+    {
+        return !operator==(that);
+    }
 
     /// @}
 
@@ -874,6 +1513,97 @@ private:
 };
 
 
+/// Maps the coordinates of a game world onto the window, so that a game
+/// whose world is bigger than the window can scroll, zoom, and rotate
+/// its view of it. Sprites added with Sprite_set::add_world_sprite are
+/// placed in world coordinates and mapped through the Sprite_set's
+/// camera when they are painted, with positions kept to a fraction of a
+/// pixel so that slow motion doesn't snap from pixel to pixel.
+///
+/// The camera's position is the world point that appears at the top
+/// left corner of the window. Zooming and rotation both pivot about the
+/// center of the window. So the default camera, which has position
+/// (0, 0), zoom 1, and rotation 0, maps world coordinates directly to
+/// window coordinates.
+///
+/// For example, to keep the player centered:
+///
+/// ```
+/// void View::draw(ge211::Sprite_set& set, Model const& model)
+/// {
+///     auto window = ge211::Dims<double>(window_dims_);
+///     camera_.set_position(model.player_position().up_left_by(window / 2));
+///     set.set_camera(camera_);
+///
+///     for (auto const& wall : model.walls())
+///         set.add_world_sprite(wall_sprite_, wall.position);
+///     ...
+/// }
+/// ```
+class Camera
+{
+public:
+    /// Constructs the identity camera, which maps world coordinates to
+    /// the same window coordinates.
+    Camera() NOEXCEPT;
+
+    /// \name Setters
+    /// @{
+
+    /// Modifies this camera to show the given world point at the top
+    /// left of the window.
+    Camera& set_position(Posn<double>) NOEXCEPT;
+
+    /// Modifies this camera to magnify the world by the given factor.
+    Camera& set_zoom(double) NOEXCEPT;
+
+    /// Modifies this camera to rotate the world clockwise by the given
+    /// angle, in degrees.
+    Camera& set_rotation(double) NOEXCEPT;
+
+    /// @}
+
+    /// \name Getters
+    /// @{
+
+    /// Returns the world point shown at the top left of the window.
+    Posn<double> get_position() const NOEXCEPT
+    { return position_; }
+
+    /// Returns the zoom factor.
+    double get_zoom() const NOEXCEPT
+    { return zoom_; }
+
+    /// Returns the rotation in degrees, in the interval [0, 360).
+    double get_rotation() const NOEXCEPT
+    { return rotation_; }
+
+    /// Does this camera only scroll, without zooming or rotating?
+    bool is_translation() const NOEXCEPT
+    { return zoom_ == 1 && rotation_ == 0; }
+
+    /// @}
+
+    /// \name Mapping
+    /// @{
+
+    /// Returns the window position where the given world position
+    /// appears, for a window with the given dimensions.
+    Posn<double> to_screen(Posn<double> world, Dims<int> window) const NOEXCEPT;
+
+    /// Returns the world position that appears at the given window
+    /// position, for a window with the given dimensions. This is useful
+    /// for finding what the mouse is pointing at.
+    Posn<double> to_world(Posn<double> screen, Dims<int> window) const NOEXCEPT;
+
+    /// @}
+
+private:
+    Posn<double> position_;
+    double zoom_;
+    double rotation_;
+};
+
 /// Gets implicitly converted to `Posn<COORDINATE>(0, 0)`
 /// for any coordinate type `COORDINATE`.
 ///
@@ -988,6 +1718,33 @@ operator<<(std::ostream& out, Rect<COORDINATE> rect)
 
 } // end namespace geometry.
 
+namespace detail {
+
+// The bounding box of a rectangle with dimensions `dims` at `xy`, as
+// rendered with `transform`: scaled away from its top-left corner, and
+// then rotated about its center.
+Rect<double> transformed_bounds(Posn<double> xy,
+                                Dims<int> dims,
+                                Transform const& transform) NOEXCEPT;
+
+// Computes transformed_bounds for `count` rectangles at once, storing
+// the ith in result[i].
+void transformed_bounds(Posn<double> const* xys,
+                        Dims<int> const* dims,
+                        Transform const* transforms,
+                        Rect<double>* result,
+                        size_t count) NOEXCEPT;
+
+// Composes each of the transforms at the given indices with `parent`,
+// in place, so that transforms[indices[i]] becomes
+// transforms[indices[i]] * parent.
+void compose_transforms(Transform* transforms,
+                        uint32_t const* indices,
+                        size_t count,
+                        Transform const& parent) NOEXCEPT;
+
+} // end namespace detail
+
 } // end namespace ge211
 
 // specializations in std:
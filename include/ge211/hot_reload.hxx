@@ -0,0 +1,77 @@
+#pragma once
+
+#include "forward.hxx"
+#include "doxygen.hxx"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ge211 {
+
+namespace detail {
+
+// Watches the resource directories for modified files and reloads the
+// images, fonts, and sound effects that were loaded from them, so that
+// art and audio can be edited while the game is running.
+//
+// Hot reloading is enabled by setting the environment variable
+// `GE211_HOT_RELOAD` to a non-empty value other than `0`. It is
+// currently supported only on Linux, where it uses inotify.
+//
+// A background thread waits for changes and decodes changed files. The
+// results are applied on the main thread, between frames, by
+// `apply_pending()`, which the engine calls once per frame.
+class Resource_watcher
+{
+public:
+    // Something to do on the main thread to finish reloading a file.
+    using Action = std::function<void()>;
+
+    // The kinds of resources that can be reloaded.
+    enum class Kind
+    {
+        image,
+        sound_effect,
+        font,
+    };
+
+    // Starts watching, if hot reloading is enabled.
+    Resource_watcher();
+
+    Resource_watcher(Resource_watcher const&) = delete;
+    Resource_watcher& operator=(Resource_watcher const&) = delete;
+
+    // Stops the watcher thread, if running.
+    ~Resource_watcher();
+
+    // Runs the actions for any files that have been reloaded since the
+    // last call.
+    void apply_pending();
+
+    // Whether the `GE211_HOT_RELOAD` environment variable requests hot
+    // reloading.
+    static bool is_requested();
+
+    // Records that a resource of the given kind was loaded from `path`
+    // (as returned by `File_resource::locate`), so that changes to that
+    // file should be reloaded. Does nothing unless hot reloading is
+    // requested. May be called from any thread.
+    static void track(std::string const& path, Kind);
+
+private:
+    struct Impl_;
+    std::unique_ptr<Impl_> impl_;
+};
+
+// Each reloader is called on the watcher thread with the path of a
+// changed file. It does whatever work it can there, such as decoding
+// the file, and returns an Action that finishes the job on the main
+// thread. Each is defined alongside the cache or registry it updates.
+Resource_watcher::Action reload_image(std::string const& path);
+Resource_watcher::Action reload_sound_effect(std::string const& path);
+Resource_watcher::Action reload_font(std::string const& path);
+
+} // end namespace detail
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "forward.hxx"
+#include "doxygen.hxx"
+#include "event.hxx"
+#include "geometry.hxx"
+#include "time.hxx"
+
+#include <bitset>
+#include <string>
+#include <vector>
+
+GE211_REGISTER_TYPE_NAME(ge211::Input_event);
+GE211_REGISTER_TYPE_NAME(ge211::Input_mode);
+GE211_REGISTER_TYPE_NAME(ge211::Input_state);
+
+namespace ge211 {
+
+namespace events {
+
+/// How the engine delivers input to the game. See
+/// @ref Abstract_game::set_input_mode.
+enum class Input_mode
+{
+    /// The engine calls Abstract_game::on_key,
+    /// Abstract_game::on_mouse_move, and the other input callbacks once
+    /// for each event. This is the default.
+    callbacks,
+    /// The engine calls no input callbacks. Instead, the game queries
+    /// @ref Abstract_game::input for the state of the keyboard and mouse,
+    /// usually from Abstract_game::on_frame.
+    snapshot,
+};
+
+/// A key or mouse button going down or up, with the time at which it
+/// happened. See Input_state::events.
+struct Input_event
+{
+    /// What happened.
+    enum class Type
+    {
+        /// A key went down. Key repeats are not recorded.
+        key_down,
+        /// A key went up.
+        key_up,
+        /// A mouse button went down.
+        mouse_down,
+        /// A mouse button went up.
+        mouse_up,
+    };
+
+    /// What happened.
+    Type type;
+
+    /// The key, for Type::key_down and Type::key_up.
+    Key key;
+
+    /// The mouse button, for Type::mouse_down and Type::mouse_up.
+    Mouse_button button;
+
+    /// The position of the mouse, for Type::mouse_down and
+    /// Type::mouse_up.
+    Posn<int> position;
+
+    /// When the event happened. This is when the engine first received
+    /// it from the operating system, which may be some time before the
+    /// frame that delivers it, so games that judge timing, such as
+    /// rhythm games, should compare this against the music rather than
+    /// using the frame time.
+    ///
+    /// The engine receives events at the start of each frame and, when
+    /// it paces frames itself, every millisecond while it waits. With
+    /// hardware vsync, though, it can't receive events while waiting
+    /// for the display, so events that happen during that wait are
+    /// stamped when it ends, which may be up to a frame late.
+    Time_point time;
+};
+
+/// A snapshot of the keyboard and mouse, as of the start of the current
+/// frame, returned by @ref Abstract_game::input.
+///
+/// The snapshot records which keys and mouse buttons are held down, and
+/// which went down or up during the events handled at the start of the
+/// frame. However many times the mouse moved, the snapshot records only
+/// where it ended up and how far it went in total, so games that don't
+/// need every intermediate position can avoid handling each one.
+///
+/// Keys are identified as they are delivered to
+/// Abstract_game::on_key_down, so letter keys are lowercase. Only the
+/// keys that Key can represent without text input (ASCII codes and the
+/// arrow and modifier keys) are tracked; for any other Key,
+/// Input_state::is_down returns false.
+class Input_state
+{
+public:
+    /// \name Keyboard
+    ///@{
+
+    /// Is the given key held down?
+    bool is_down(Key key) const NOEXCEPT
+    { return test_(keys_down_, key); }
+
+    /// Did the given key go down this frame? (It may have gone back up
+    /// as well.)
+    bool was_pressed(Key key) const NOEXCEPT
+    { return test_(keys_pressed_, key); }
+
+    /// Did the given key go up this frame?
+    bool was_released(Key key) const NOEXCEPT
+    { return test_(keys_released_, key); }
+
+    /// The keys that went down this frame, in order. Key repeats are not
+    /// included.
+    std::vector<Key> const& pressed_keys() const NOEXCEPT
+    { return pressed_keys_; }
+
+    /// The keys that went up this frame, in order.
+    std::vector<Key> const& released_keys() const NOEXCEPT
+    { return released_keys_; }
+
+    /// The text typed this frame, encoded as UTF-8.
+    std::string const& text() const NOEXCEPT
+    { return text_; }
+
+    ///@}
+
+    /// \name Mouse
+    ///@{
+
+    /// Is the given mouse button held down?
+    bool is_down(Mouse_button button) const NOEXCEPT
+    { return buttons_down_[size_t(button)]; }
+
+    /// Did the given mouse button go down this frame?
+    bool was_pressed(Mouse_button button) const NOEXCEPT
+    { return buttons_pressed_[size_t(button)]; }
+
+    /// Did the given mouse button go up this frame?
+    bool was_released(Mouse_button button) const NOEXCEPT
+    { return buttons_released_[size_t(button)]; }
+
+    /// The position of the mouse, as of its most recent event.
+    Posn<int> mouse_position() const NOEXCEPT
+    { return mouse_position_; }
+
+    /// How far the mouse moved this frame.
+    Dims<int> mouse_motion() const NOEXCEPT
+    { return mouse_motion_; }
+
+    ///@}
+
+    /// \name Timing
+    ///@{
+
+    /// The keys and mouse buttons that went down or up this frame, in
+    /// the order that they happened, with their timestamps.
+    std::vector<Input_event> const& events() const NOEXCEPT
+    { return events_; }
+
+    ///@}
+
+private:
+    friend detail::Input_tracker;
+
+    // One slot for each ASCII code, then one for each Key::Type from
+    // up through command.
+    static constexpr size_t key_slots = 128 + size_t(Key::Type::other) - 1;
+    using Key_bits_ = std::bitset<key_slots>;
+    using Button_bits_ = std::bitset<3>;
+
+    // Returns the slot for a key, or key_slots if it isn't tracked.
+    static size_t slot_(Key) NOEXCEPT;
+
+    static bool test_(Key_bits_ const& bits, Key key) NOEXCEPT
+    {
+        size_t slot = slot_(key);
+        return slot < key_slots && bits[slot];
+    }
+
+    Key_bits_ keys_down_;
+    Key_bits_ keys_pressed_;
+    Key_bits_ keys_released_;
+    std::vector<Key> pressed_keys_;
+    std::vector<Key> released_keys_;
+    std::string text_;
+
+    Button_bits_ buttons_down_;
+    Button_bits_ buttons_pressed_;
+    Button_bits_ buttons_released_;
+    Posn<int> mouse_position_{0, 0};
+    Dims<int> mouse_motion_{0, 0};
+
+    std::vector<Input_event> events_;
+};
+
+} // end namespace events
+
+namespace detail {
+
+// Builds the Input_state from events as the engine handles them.
+class Input_tracker
+{
+public:
+    // Starts a new frame, forgetting the previous frame's edges,
+    // motion and text.
+    void begin_frame() NOEXCEPT;
+
+    // Each of these takes the time at which the event happened.
+    void key_down(Key, bool repeat, Time_point = {});
+    void key_up(Key, Time_point = {});
+    void text_input(char const* utf8);
+    void mouse_down(Mouse_button, Posn<int>, Time_point = {});
+    void mouse_up(Mouse_button, Posn<int>, Time_point = {});
+    void mouse_move(Posn<int>, Dims<int> relative) NOEXCEPT;
+
+    Input_state const& state() const NOEXCEPT
+    { return state_; }
+
+private:
+    Input_state state_;
+};
+
+} // end namespace detail
+
+}
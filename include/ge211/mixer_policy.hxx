@@ -0,0 +1,70 @@
+#pragma once
+
+#include "forward.hxx"
+#include "audio.hxx"
+#include "doxygen.hxx"
+
+#include <cstdint>
+#include <vector>
+
+namespace ge211 {
+
+namespace detail {
+
+// The choices the Mixer makes about which sound effects to play and
+// how loud, kept apart from SDL_mixer so that they can be tested on
+// their own.
+
+// The stereo volumes of a positional sound effect, each from 0 to 255,
+// as passed to Mix_SetPanning.
+struct Spatial_panning
+{
+    // False if the effect is at or beyond the maximum distance, where
+    // it is silent, in which case it should be culled.
+    bool audible;
+    uint8_t left;
+    uint8_t right;
+};
+
+// Finds how loud an effect at `emitter` sounds in each ear to a
+// listener at `listener`. Volume falls linearly from full at the
+// reference distance to zero at the maximum distance, and the effect
+// is panned by its horizontal offset using a constant-power pan law,
+// scaled so that a centered effect plays at full volume in both ears.
+Spatial_panning spatialize(Posn<double> listener,
+                           Posn<double> emitter,
+                           Mixer::Attenuation const& attenuation) NOEXCEPT;
+
+// A playing sound effect that could be stopped to make room for a new
+// one.
+struct Steal_candidate
+{
+    int channel;
+    int priority;
+    // The channel volume, which only Voice_stealing::quietest uses.
+    int volume;
+    // Increases with each effect played, so lower is older.
+    unsigned long serial;
+    // Identifies the effect's samples, for instance limits.
+    void const* samples;
+};
+
+// Whether an effect with the given instance limit (0 for none) may
+// start another copy while `playing` copies are playing.
+bool within_instance_limit(int playing, int max_instances) NOEXCEPT;
+
+// Chooses which of `candidates` to stop to make room for an effect with
+// priority `priority`, under `policy`. Only effects of no higher
+// priority qualify and, if `samples` is non-null, only those playing
+// `samples`. Prefers the lowest priority, and then the oldest or, for
+// Voice_stealing::quietest, the quietest and then the oldest. Returns
+// the chosen channel, or -1 if none qualifies or `policy` is
+// Voice_stealing::none.
+int choose_victim(Mixer::Voice_stealing policy,
+                  std::vector<Steal_candidate> const& candidates,
+                  int priority,
+                  void const* samples) NOEXCEPT;
+
+} // end namespace detail
+
+} // end namespace ge211
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "forward.hxx"
+#include "doxygen.hxx"
+#include "util.hxx"
+
+#include <SDL_rwops.h>
+
+#include <memory>
+#include <string>
+
+namespace ge211 {
+
+namespace detail {
+
+// Reads a music file ahead of its decoder. SDL_mixer decodes music on
+// the audio thread, reading the file as it goes; this gives it an
+// SDL_RWops that reads from a buffer instead, which a dedicated thread
+// keeps filled from the file, so that the audio thread doesn't wait on
+// the disk.
+//
+// The start of the file is kept in memory permanently, since decoders
+// seek back to it to loop or rewind. Other seeks outside the buffer
+// restart the reader thread at the new position.
+//
+// Reading never blocks once start_realtime() has been called, so the
+// audio thread can't be held up by the disk or by the reader thread.
+class Music_stream
+{
+public:
+    // Opens the file at `path` for streaming. Returns an SDL_RWops that
+    // reads from the stream and shares ownership of it; closing the
+    // SDL_RWops stops the reader thread. Stores another reference to the
+    // stream in `stream`, for reporting statistics. Returns null if the
+    // file can't be opened.
+    static Owned<SDL_RWops>
+    open(std::string const& path, std::shared_ptr<Music_stream>& stream);
+
+    // Declares that loading is done, and that from now on the stream is
+    // read in the audio callback. Reads then never wait for the reader
+    // thread; a read that finds too little buffered is padded with
+    // zeros and counts as an underrun.
+    void start_realtime() NOEXCEPT;
+
+    // The number of bytes read ahead and not yet consumed.
+    size_t buffered_bytes() const NOEXCEPT;
+
+    // The size of the read-ahead buffer in bytes.
+    size_t capacity_bytes() const NOEXCEPT;
+
+    // How many times a real-time read was padded because the reader
+    // thread hadn't caught up.
+    unsigned long underruns() const NOEXCEPT;
+
+    Music_stream(Music_stream const&) = delete;
+    Music_stream& operator=(Music_stream const&) = delete;
+
+    ~Music_stream();
+
+private:
+    struct Impl_;
+
+    explicit Music_stream(std::unique_ptr<Impl_>);
+
+    static Impl_& impl_of_(SDL_RWops*);
+
+    static Sint64 SDLCALL size_(SDL_RWops*);
+    static Sint64 SDLCALL seek_(SDL_RWops*, Sint64, int);
+    static size_t SDLCALL read_(SDL_RWops*, void*, size_t, size_t);
+    static size_t SDLCALL write_(SDL_RWops*, void const*, size_t, size_t);
+    static int SDLCALL close_(SDL_RWops*);
+
+    std::unique_ptr<Impl_> impl_;
+};
+
+} // end namespace detail
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "forward.hxx"
+#include "doxygen.hxx"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ge211 {
+
+namespace detail {
+
+// A `Resource_pack` is a read-only archive of resource files, all stored
+// in one file so that a game with many small assets can find them
+// without probing the filesystem once per asset per prefix.
+//
+// The file format, all integers little-endian:
+//
+//   header:  magic "GE211PK\0", u32 version, u32 entry count
+//   index:   one 40-byte entry per file, sorted by (hash, name):
+//              u64 FNV-1a hash of the name, u64 data offset, u64 data size,
+//              u32 name offset, u32 name length, u32 flags, u32 reserved
+//   names:   the names, concatenated, not NUL-terminated
+//   data:    the file contents, concatenated
+//
+// Offsets are relative to the start of the file. Flags must be 0
+// (stored uncompressed); other values are reserved for compressed
+// entries and are rejected by this version of the reader.
+class Resource_pack
+{
+public:
+    // The name of the pack file that the session looks for among the
+    // resource search prefixes.
+    static char const* const default_filename;
+
+    // A file's contents, borrowed from the pack.
+    struct Blob
+    {
+        char const* data;
+        size_t size;
+    };
+
+    // The empty pack, which contains nothing.
+    Resource_pack() NOEXCEPT;
+
+    // Replaces the contents of this pack with the pack file read from
+    // the given stream. Returns false, leaving the pack empty, if the
+    // stream does not contain a well-formed pack.
+    bool load(std::istream&);
+
+    // Looks up a file by name. Returns true and sets `out` if found.
+    bool find(std::string const& name, Blob& out) const NOEXCEPT;
+
+    // The number of files in the pack.
+    size_t size() const NOEXCEPT { return index_.size(); }
+
+    bool empty() const NOEXCEPT { return index_.empty(); }
+
+    // Writes a pack file containing the given (name, contents) pairs.
+    // Throws Client_logic_error if a name is repeated, or if there are
+    // too many files or names for the format's 32-bit fields.
+    static void write(std::ostream&,
+                      std::vector<std::pair<std::string, std::string>>);
+
+    // The hash function used for the index.
+    static uint64_t hash(char const* name, size_t length) NOEXCEPT;
+
+private:
+    struct Entry_
+    {
+        uint64_t hash;
+        uint64_t offset;
+        uint64_t size;
+        uint32_t name_offset;
+        uint32_t name_length;
+    };
+
+    std::string bytes_;
+    std::vector<Entry_> index_;
+};
+
+} // end namespace detail
+
+}
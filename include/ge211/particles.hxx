@@ -0,0 +1,171 @@
+#pragma once
+
+#include "color.hxx"
+#include "forward.hxx"
+#include "geometry.hxx"
+#include "doxygen.hxx"
+#include "sprites.hxx"
+
+#include <cstdint>
+#include <vector>
+
+GE211_REGISTER_TYPE_NAME(ge211::Particle_system);
+
+namespace ge211 {
+
+namespace sprites {
+
+/// A pool of small, short-lived colored squares, such as sparks, smoke,
+/// or the stars of a firework, that move and fade on their own.
+///
+/// A Particle_system holds up to a fixed number of particles, given when
+/// it is constructed. Each particle has a position, a velocity, a color,
+/// and a lifetime. Every frame, you should call update(double) with the
+/// time since the previous frame, which moves each particle, applies
+/// gravity, fades it out over its lifetime, and removes the particles
+/// whose lifetime is up.
+///
+/// A Particle_system is itself a Sprite: to draw all of its particles,
+/// add it to the @ref Sprite_set once, and it renders them together, in
+/// one batch where SDL allows. This is far faster than adding a sprite
+/// for every particle, and supports hundreds of thousands of particles.
+///
+/// Particle positions are relative to the position where the
+/// Particle_system is added to the @ref Sprite_set, and must stay within
+/// its dimensions, given as `extent` to the constructor: particles that
+/// move out of that rectangle are removed. The scale of a [Transform] is
+/// applied to the whole system, but its rotation and flips are ignored.
+///
+/// For example, this adds a burst of 100 sparks in all directions:
+///
+/// ```cpp
+/// struct My_game : Abstract_game
+/// {
+///     Particle_system sparks{10000, initial_window_dimensions()};
+///
+///     void burst(Posn<float> where)
+///     {
+///         for (int i = 0; i < 100; ++i) {
+///             Dims<float> v{float(100 * std::cos(i)),
+///                           float(100 * std::sin(i))};
+///             sparks.emit(where, v, Color::medium_yellow(), 1.5);
+///         }
+///     }
+///
+///     void on_frame(double dt) override
+///     {
+///         sparks.update(dt);
+///     }
+///
+///     void draw(Sprite_set& set) override
+///     {
+///         set.add_sprite(sparks, {0, 0});
+///     }
+/// };
+/// ```
+///
+/// [Transform]: @ref ge211::geometry::Transform
+class Particle_system : public Sprite
+{
+public:
+    /// Constructs an empty Particle_system with room for `capacity`
+    /// particles, each `particle_size` pixels square, which live within
+    /// the rectangle from the origin to `extent`.
+    ///
+    /// \preconditions
+    ///  - `extent` is positive in both dimensions, and `particle_size` is
+    ///    positive; throws exceptions::Client_logic_error if violated.
+    Particle_system(size_t capacity, Dims<int> extent,
+                    float particle_size = 2);
+
+    /// The dimensions of the rectangle that particles live within.
+    Dims<int> dimensions() const override;
+
+    /// \name Particles
+    /// @{
+
+    /// Adds a particle at the given position, moving with the given
+    /// velocity in pixels per second, that fades out over `lifetime`
+    /// seconds. Returns false, and adds nothing, if the system is full
+    /// or the position is outside the extent.
+    bool emit(Posn<float> position,
+              Dims<float> velocity,
+              Color color,
+              double lifetime);
+
+    /// Moves every particle forward by `dt` seconds, and removes those
+    /// that have lived out their lifetimes or left the extent.
+    void update(double dt);
+
+    /// Removes every particle.
+    void clear() NOEXCEPT;
+
+    /// The number of live particles.
+    size_t size() const NOEXCEPT
+    { return size_; }
+
+    /// The most particles this system can hold.
+    size_t capacity() const NOEXCEPT
+    { return x_.size(); }
+
+    /// Whether there are no live particles.
+    bool empty() const NOEXCEPT
+    { return size_ == 0; }
+
+    /// @}
+
+    /// \name Settings
+    /// @{
+
+    /// The acceleration applied to every particle, in pixels per second
+    /// squared. The default is none.
+    Dims<float> get_gravity() const NOEXCEPT
+    { return gravity_; }
+
+    /// Sets the acceleration applied to every particle.
+    Particle_system& set_gravity(Dims<float> gravity) NOEXCEPT
+    {
+        gravity_ = gravity;
+        return *this;
+    }
+
+    /// Whether particles fade out linearly over their lifetimes. The
+    /// default is true.
+    bool get_fade() const NOEXCEPT
+    { return fade_; }
+
+    /// Sets whether particles fade out over their lifetimes.
+    Particle_system& set_fade(bool fade) NOEXCEPT
+    {
+        fade_ = fade;
+        return *this;
+    }
+
+    /// @}
+
+private:
+    void render(detail::Renderer&, Posn<int>, Transform const&) const override;
+
+    void integrate_(float dt) NOEXCEPT;
+    void age_and_fade_(float dt) NOEXCEPT;
+    void remove_dead_() NOEXCEPT;
+
+    Dims<int> extent_;
+    float particle_size_;
+    Dims<float> gravity_{0, 0};
+    bool fade_ = true;
+    size_t size_ = 0;
+
+    // Each particle's state, in parallel arrays of fixed length, so that
+    // each step of update() streams through only the arrays it needs.
+    // Only the first size_ elements are live.
+    std::vector<float> x_, y_;
+    std::vector<float> dx_, dy_;
+    std::vector<float> age_, lifetime_;
+    std::vector<float> opacity_;
+    std::vector<Color> color_;
+};
+
+} // end namespace sprites
+
+}
@@ -9,8 +9,10 @@
 
 #include <SDL_render.h>
 #include <SDL_surface.h>
+#include <SDL_version.h>
 
 #include <memory>
+#include <vector>
 
 namespace ge211 {
 
@@ -34,6 +36,65 @@ public:
     void clear();
     void copy(const Texture&, Posn<int>);
     void copy(const Texture&, Posn<int>, const Transform&);
+    void copy(const Texture&, Posn<float>, const Transform&);
+
+    // Copies just the `source` region of the texture, unscaled, with
+    // its top-left corner at `xy`.
+    void copy(const Texture&, const Rect<int>& source, Posn<int> xy);
+
+    // The dimensions of the current render target: a texture, if a
+    // Target_scope is active, or else the window.
+    Dims<int> output_dimensions() const;
+
+    // Fills `count` rectangles, each `size` scaled by `scale`, the ith
+    // with its top-left corner at `offset` plus (xs[i], ys[i]) scaled
+    // by `scale`, in colors[i] with its alpha multiplied by
+    // opacities[i]. This takes a single draw call where SDL supports it.
+    void fill_squares(const float* xs, const float* ys,
+                      const Color* colors, const float* opacities,
+                      size_t count, float size,
+                      Posn<float> offset, Dims<float> scale);
+
+    // Creates a transparent texture that can be rendered into, using a
+    // Target_scope. Throws Host_error if this renderer can't render to
+    // textures.
+    //
+    // Drawing into a target leaves its colors premultiplied by alpha,
+    // so where SDL supports it (2.0.6 and later), targets are blended
+    // as premultiplied when copied. Otherwise translucent pixels come
+    // out darker than they would drawn directly.
+    Texture create_target(Dims<int>);
+
+    // Clears the current target, made by create_target, to the given
+    // color.
+    void clear_target(Color);
+
+    // Counts the times that the renderer has lost the contents of its
+    // render targets, which happens with some drivers (such as
+    // Direct3D) when the device is reset. Anything cached in a target
+    // must be painted again when this changes.
+    unsigned long target_generation() const NOEXCEPT
+    { return target_generation_; }
+
+    // Handles SDL_RENDER_TARGETS_RESET.
+    void targets_reset() NOEXCEPT
+    { ++target_generation_; }
+
+    // Directs this renderer's drawing into a texture made by
+    // create_target for as long as the Target_scope lives, and then
+    // restores the previous target. Scopes may nest.
+    class Target_scope
+    {
+    public:
+        Target_scope(Renderer&, const Texture& target);
+        Target_scope(const Target_scope&) = delete;
+        Target_scope& operator=(const Target_scope&) = delete;
+        ~Target_scope();
+
+    private:
+        Renderer& renderer_;
+        Borrowed<SDL_Texture> previous_;
+    };
 
     // Prepares a texture for rendering with this given renderer, without
     // actually copying it.
@@ -51,6 +112,16 @@ private:
     create_renderer_(Borrowed<SDL_Window>);
 
     Uniq_SDL_Renderer ptr_;
+
+    unsigned long target_generation_ = 0;
+    // Whether create_target makes premultiplied textures.
+    bool premultiplied_targets_ = false;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    // Kept between calls to fill_squares to avoid reallocating.
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+#endif
 };
 
 // A texture is initially created as a (device-independent) `SDL_Surface`,
@@ -77,6 +148,15 @@ public:
 
     bool empty() const NOEXCEPT;
 
+    // Returns whether any other `Texture` refers to the same
+    // underlying image as this one.
+    bool is_shared() const NOEXCEPT;
+
+    // Replaces the image, for this `Texture` and every copy of it, with
+    // the given surface, which will be converted to a texture when next
+    // rendered.
+    void replace(Uniq_SDL_Surface);
+
 private:
     friend Renderer;
 
@@ -17,6 +17,7 @@ TTF_CloseFont(TTF_Font *);
 }
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,18 +25,46 @@ namespace ge211 {
 
 /// Opens a file in the `Resources/` directory for input in text mode.
 ///
+/// Unlike images, sounds, music and fonts, files opened this way are
+/// never read from a resource pack made with `ge211-pack`, so ship
+/// them as ordinary files in the `Resources/` directory.
+///
 /// Throws @ref exceptions::File_open_error if the file cannot be opened.
 std::ifstream
 open_resource_file(std::string const& filename);
 
 /// Opens a file in the `Resources/` directory for input in binary mode.
 ///
+/// Like open_resource_file(), this never reads from a resource pack.
+///
 /// Throws @ref exceptions::File_open_error if the file cannot be opened.
 std::ifstream
 open_binary_resource_file(std::string const& filename);
 
+/// Scans the `Resources/` directories once, up front, and remembers
+/// where each file is found.
+///
+/// %ge211 always remembers which directory a resource was found in, so
+/// that loading the same file again doesn't search the filesystem.
+/// Calling this function, for example from your game's constructor,
+/// does that searching for every resource at once, which can make the
+/// first load of each resource faster for games that have many of them.
+void scan_resource_directories();
+
 namespace detail {
 
+// Identifies where a resource would be loaded from, without loading
+// it, so that loaded resources can be cached.
+struct Resource_location
+{
+    // The path the resource would be opened from or, for a resource in
+    // the resource pack, its name prefixed by "pack:".
+    std::string path;
+
+    // The file's last modification time, or 0 if unknown.
+    long long mtime;
+};
+
 class File_resource
 {
 private:
@@ -46,8 +75,23 @@ private:
     delete_ptr ptr_;
 
 public:
+    // Opens the named resource, looking first in the resource pack
+    // and then in each resource search prefix.
     explicit File_resource(const std::string&);
 
+    // Returns the process-wide resource pack, loading it on first call.
+    // The pack is loaded at most once and is never unloaded, so
+    // borrowed blobs remain valid for the life of the program.
+    static Resource_pack const& pack();
+
+    // Finds the named resource the same way the constructor does, but
+    // without opening it. Throws File_open_error if it doesn't exist.
+    static Resource_location locate(const std::string&);
+
+    // The directories searched for resources, in order, each ending
+    // with a slash.
+    static std::vector<std::string> search_directories();
+
     Borrowed<SDL_RWops>
     get_raw() const NOEXCEPT
     {
@@ -88,12 +132,21 @@ public:
 
 private:
     friend Text_sprite;
+    friend detail::Font_registry;
+
+    // Shared, so that a hot reload can replace the underlying TTF_Font
+    // for every Font loaded from the same file.
+    struct Impl_
+    {
+        util::pointers::Delete_ptr<TTF_Font, &TTF_CloseFont> ptr;
+        int size;
+    };
 
     Borrowed<TTF_Font>
     get_raw_() const NOEXCEPT
-    { return ptr_.get(); }
+    { return impl_->ptr.get(); }
 
-    util::pointers::Delete_ptr<TTF_Font, &TTF_CloseFont> ptr_;
+    std::shared_ptr<Impl_> impl_;
 };
 
 }
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "forward.hxx"
+#include "doxygen.hxx"
+#include "util/spsc_queue.hxx"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ge211 {
+
+namespace detail {
+
+// The playback state of one software voice. This is owned by the audio
+// thread once the voice starts.
+struct Voice_state
+{
+    // Interleaved 16-bit samples in the device's format and channel
+    // count, borrowed from a Mix_Chunk that the main thread keeps alive.
+    int16_t const* samples = nullptr;
+    size_t frames = 0;
+
+    // Playback position, in source frames, and how far it advances per
+    // output frame (the pitch ratio).
+    double position = 0;
+    double step = 1;
+
+    // Current gain, and the gain it is ramping toward over the next
+    // ramp_frames output frames.
+    float gain = 1;
+    float target_gain = 1;
+    long ramp_frames = 0;
+
+    // Per-output-channel gains from panning.
+    float left = 1;
+    float right = 1;
+
+    bool loop = false;
+};
+
+// Sets a voice's per-channel gains for a pan position from -1 (left) to
+// 1 (right), using a constant-power pan law.
+void set_voice_pan(Voice_state&, float pan) NOEXCEPT;
+
+// Mixes up to `frames` frames of `voice` into the accumulator `acc`,
+// which is interleaved with `channels` (1 or 2) channels, advancing
+// the voice. Returns false once the voice has ended.
+bool mix_voice(Voice_state& voice,
+               float* acc,
+               size_t frames,
+               int channels) NOEXCEPT;
+
+// Adds the accumulated samples to the 16-bit `stream`, which holds `n`
+// samples, saturating at the limits of the format.
+void add_and_clip(float const* acc, int16_t* stream, size_t n) NOEXCEPT;
+
+// An optional mixing stage, run after SDL_mixer mixes its channels,
+// that plays any number of voices with per-voice gain ramps, panning
+// and pitch. Voices are controlled from the main thread by sending
+// commands to the audio thread through a lock-free queue, and the audio
+// thread reports finished voices back the same way.
+class Software_mixer
+{
+public:
+    using Voice_id = uint32_t;
+
+    // Registers the stage with SDL_mixer. The device must use 16-bit
+    // samples with 1 or 2 channels.
+    Software_mixer(int channels, int frequency, int max_voices);
+
+    Software_mixer(Software_mixer const&) = delete;
+    Software_mixer& operator=(Software_mixer const&) = delete;
+
+    // Unregisters the stage.
+    ~Software_mixer();
+
+    // Starts a voice playing `chunk`, which must be in the device's
+    // format. Returns 0 if there are already `max_voices` voices.
+    Voice_id play(std::shared_ptr<Mix_Chunk> chunk,
+                  float gain, float pan, float pitch, bool loop);
+
+    // Each of these has no effect if the voice has finished.
+    void set_gain(Voice_id, float gain, long ramp_frames);
+    void set_pan(Voice_id, float pan);
+    void set_pitch(Voice_id, float pitch);
+    void stop(Voice_id);
+
+    // Forgets the voices that the audio thread has reported finished,
+    // releasing their chunks. Also retries any commands that didn't fit
+    // in the queue, and frees samples retired by stop_voices_using.
+    void collect_finished();
+
+    // Whether the voice was started and not yet collected.
+    bool is_live(Voice_id id) const { return live_.count(id) != 0; }
+
+    // The number of voices started and not yet collected.
+    size_t voice_count() const NOEXCEPT { return live_.size(); }
+
+    int frequency() const NOEXCEPT { return frequency_; }
+
+    // Stops every voice playing the given samples. If `free_samples`,
+    // they are passed to SDL_free once the audio thread has
+    // acknowledged the stops, since until then it may still be mixing
+    // them. Main thread only.
+    static void stop_voices_using(uint8_t* samples, bool free_samples);
+
+private:
+    struct Command_
+    {
+        // A fence does nothing but tell the main thread, through
+        // fence_done_, that the commands before it have been applied.
+        enum class Kind { start, gain, pan, pitch, stop, fence };
+
+        Kind kind;
+        Voice_id id;
+        float value;
+        long ramp_frames;
+        Voice_state state;
+    };
+
+    static void post_mix_(void* self, uint8_t* stream, int len);
+    // Sends a command for a voice, unless it has finished.
+    void send_(Command_ const&);
+    void push_(Command_ const&);
+    void flush_backlog_();
+    void free_retired_();
+    void apply_commands_();
+    void remove_voice_(size_t index);
+    void mix_(int16_t* stream, size_t samples);
+
+    static constexpr size_t queue_capacity = 4096;
+
+    // Voices are mixed this many frames at a time.
+    static constexpr size_t block_frames = 1024;
+
+    // The mixer is a singleton, since SDL_mixer has one post-mix hook.
+    static Software_mixer* active_;
+
+    int channels_;
+    int frequency_;
+    size_t max_voices_;
+
+    // Main thread only:
+    Voice_id next_id_ = 1;
+    std::unordered_map<Voice_id, std::shared_ptr<Mix_Chunk>> live_;
+    // Commands that didn't fit in the queue, to be sent before any
+    // others.
+    std::deque<Command_> backlog_;
+    // Samples to free once fence_done_ reaches the paired fence.
+    std::vector<std::pair<uint32_t, void*>> retired_;
+    uint32_t next_fence_ = 1;
+
+    util::containers::Spsc_queue<Command_, queue_capacity> commands_;
+    util::containers::Spsc_queue<Voice_id, queue_capacity> finished_;
+    // The last fence applied by the audio thread.
+    std::atomic<uint32_t> fence_done_{0};
+
+    // Audio thread only, allocated up front:
+    std::vector<Voice_state> voices_;
+    std::vector<Voice_id> voice_ids_;
+    std::vector<Voice_id> unreported_;
+    std::vector<float> acc_;
+};
+
+} // end namespace detail
+
+}
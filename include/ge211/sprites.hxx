@@ -8,6 +8,7 @@
 #include "render.hxx"
 #include "resource.hxx"
 
+#include <cstdint>
 #include <vector>
 #include <sstream>
 
@@ -16,6 +17,7 @@ GE211_REGISTER_TYPE_NAME(ge211::Circle_sprite);
 GE211_REGISTER_TYPE_NAME(ge211::Image_sprite);
 GE211_REGISTER_TYPE_NAME(ge211::Multiplexed_sprite);
 GE211_REGISTER_TYPE_NAME(ge211::Rectangle_sprite);
+GE211_REGISTER_TYPE_NAME(ge211::Render_target_sprite);
 GE211_REGISTER_TYPE_NAME(ge211::Text_sprite);
 GE211_REGISTER_TYPE_NAME(ge211::Sprite);
 GE211_REGISTER_TYPE_NAME(ge211::Sprite_set);
@@ -60,13 +62,20 @@ public:
 
 private:
     friend class detail::Engine;
-    friend struct detail::Placed_sprite;
+    friend class detail::Placed_sprites;
     friend Multiplexed_sprite;
+    friend Tile_map;
 
     virtual void render(detail::Renderer&,
                         Posn<int>,
                         Transform const&) const = 0;
 
+    // Renders at a position that may fall between pixels. By default,
+    // this rounds to the nearest pixel.
+    virtual void render_subpixel(detail::Renderer&,
+                                 Posn<float>,
+                                 Transform const&) const;
+
     virtual void prepare(detail::Renderer const&) const {}
 };
 
@@ -89,8 +98,13 @@ public:
 
 private:
     void render(detail::Renderer&, Posn<int>, Transform const&) const override;
+    void render_subpixel(detail::Renderer&, Posn<float>,
+                         Transform const&) const override;
     void prepare(detail::Renderer const&) const override;
 
+    // Tile_map slices the texture into tiles.
+    friend sprites::Tile_map;
+
     virtual Texture const& get_texture_() const = 0;
 };
 
@@ -228,6 +242,48 @@ public:
     /// including JPEG, PNG, GIF, BMP, etc.
     explicit Image_sprite(std::string const& filename);
 
+    /// \name Image cache
+    ///
+    /// Image_sprite%s constructed from the same file share one copy of
+    /// the decoded image (and, once rendered, one copy in video memory).
+    /// %ge211 keeps each image in a cache after loading it, so creating
+    /// an Image_sprite for a file that has been loaded before, even if
+    /// all the sprites using it have since been destroyed, doesn't read
+    /// or decode the file again. If the file has been modified since it
+    /// was cached, it is reloaded.
+    ///
+    /// The cache is emptied automatically when your game exits. These
+    /// functions let you inspect or empty it sooner, which may be useful
+    /// if your game has many large images that it uses only briefly.
+    ///@{
+
+    /// Statistics about the image cache, as returned by
+    /// @ref Image_sprite::cache_stats().
+    struct Cache_stats
+    {
+        /// The number of images currently in the cache.
+        size_t entries;
+        /// How many Image_sprite%s have been constructed by reusing a
+        /// cached image.
+        size_t hits;
+        /// How many Image_sprite%s have been constructed by loading an
+        /// image file.
+        size_t misses;
+    };
+
+    /// Returns statistics about the image cache.
+    static Cache_stats cache_stats();
+
+    /// Removes from the cache all images that are not currently used by
+    /// any Image_sprite.
+    static void evict_unused_images();
+
+    /// Removes all images from the cache. Existing Image_sprite%s are
+    /// unaffected, but no new Image_sprite will share their images.
+    static void clear_image_cache();
+
+    ///@}
+
 private:
     detail::Texture const& get_texture_() const override;
 
@@ -475,6 +531,8 @@ protected:
 private:
     void render(detail::Renderer& renderer, Posn<int> position,
                 Transform const& transform) const override;
+    void render_subpixel(detail::Renderer& renderer, Posn<float> position,
+                         Transform const& transform) const override;
 
     detail::Timer timer_;
 };
@@ -483,19 +541,78 @@ private:
 
 namespace detail {
 
-struct Placed_sprite
+// The sprites added to a Sprite_set, stored as parallel arrays so that
+// each pass over them when painting reads only the fields it needs. Most
+// sprites have the identity transform, so transforms are stored apart,
+// only for the sprites that have one.
+class Placed_sprites
 {
-    const Sprite* sprite;
-    Posn<int> xy;
-    int z;
-    Transform transform;
+public:
+    void add(Sprite const&, Posn<double>, int z, Transform const&,
+             bool in_world);
 
-    Placed_sprite(Sprite const&, Posn<int>, int, Transform const&) NOEXCEPT;
+    // Adds a copy of the sprite at each screen position. Either `zs` or
+    // `transforms` may be null, in which case each copy has z `z` or the
+    // identity transform, respectively; otherwise they must point to
+    // one element per position.
+    void add_run(Sprite const&, std::vector<Posn<int>> const& positions,
+                 int z, int const* zs, Transform const* transforms);
 
+    size_t size() const NOEXCEPT
+    { return sprites_.size(); }
+
+    // Maps the sprites placed in world coordinates to the screen.
+    void apply_camera(Camera const&, Dims<int> window);
+
+    // Puts the sprites in painting order, by increasing z, leaving out
+    // those entirely outside `screen` if `cull` is true. Returns the
+    // number of sprites left to paint.
+    size_t order(bool cull, Dims<int> screen);
+
+    // Renders the sprites in the order found by order().
     void render(Renderer&) const;
-};
 
-bool operator<(Placed_sprite const&, Placed_sprite const&) NOEXCEPT;
+    void clear() NOEXCEPT;
+
+private:
+    Transform const& transform_(size_t) const NOEXCEPT;
+    Transform& mutable_transform_(size_t);
+
+    // Stores a transform for the given sprite, returning its index.
+    uint32_t store_transform_(size_t sprite, Transform const&);
+
+    // Fills bounds_ with the bounding box of the pixels that render_
+    // may draw for each sprite.
+    void compute_bounds_();
+
+    void render_(size_t, Renderer&) const;
+
+    // The transform index of a sprite with the identity transform.
+    static constexpr uint32_t identity_ = ~uint32_t(0);
+
+    std::vector<Sprite const*> sprites_;
+    std::vector<Posn<double>> positions_;
+    std::vector<int> zs_;
+    // For each sprite, its index in transforms_, or identity_.
+    std::vector<uint32_t> transform_indices_;
+    std::vector<Transform> transforms_;
+    // For each transform, the index of its sprite.
+    std::vector<uint32_t> transform_owners_;
+    // The indices of the sprites placed in world coordinates.
+    std::vector<uint32_t> in_world_;
+    // Painting order, with each sprite's biased z in the high half and
+    // its index in the low half, so that sorting compares integers only.
+    std::vector<uint64_t> order_;
+
+    // Scratch space for apply_camera and compute_bounds_, kept to avoid
+    // reallocating every frame.
+    std::vector<uint32_t> world_transforms_;
+    std::vector<Rect<double>> bounds_;
+    std::vector<Dims<int>> dims_;
+    std::vector<Posn<double>> transformed_xys_;
+    std::vector<Dims<int>> transformed_dims_;
+    std::vector<Rect<double>> transformed_bounds_;
+};
 
 } // end namespace detail
 
@@ -554,11 +671,182 @@ public:
                            int z = 0,
                            Transform const& transform = Transform());
 
+    /// Adds many copies of one sprite, all at the same *z* and without
+    /// transforms, to render in the next frame. This is equivalent to
+    /// calling add_sprite(Sprite const&, Posn<int>, int, Transform const&)
+    /// once for each position, but much faster when there are thousands
+    /// of positions, as with particles.
+    ///
+    /// \param sprite The sprite to render at each position.
+    /// \param positions The (*x*, *y*) coordinates of each copy's
+    /// top-left corner.
+    /// \param z (*optional*, defaults to 0) The *z* coordinate of every
+    /// copy.
+    /// \return a reference to this same Sprite_set
+    ///
+    /// \ownership
+    ///
+    /// As with add_sprite, the sprite is borrowed and must outlive the
+    /// current call to @ref Abstract_game::draw. The positions are
+    /// copied, so the vector may change right away.
+    Sprite_set& add_sprites(Sprite const& sprite,
+                            std::vector<Posn<int>> const& positions,
+                            int z = 0);
+
+    /// Adds many copies of one sprite, each with its own *z*. The
+    /// vectors must be the same length; `zs[i]` is the *z* coordinate
+    /// of the copy at `positions[i]`. Throws
+    /// exceptions::Client_logic_error if they are not.
+    Sprite_set& add_sprites(Sprite const& sprite,
+                            std::vector<Posn<int>> const& positions,
+                            std::vector<int> const& zs);
+
+    /// Adds many copies of one sprite, each with its own *z* and
+    /// [Transform]. The vectors must be the same length; throws
+    /// exceptions::Client_logic_error if they are not.
+    ///
+    /// [Transform]: @ref ge211::geometry::Transform
+    Sprite_set& add_sprites(Sprite const& sprite,
+                            std::vector<Posn<int>> const& positions,
+                            std::vector<int> const& zs,
+                            std::vector<Transform> const& transforms);
+
+    /// Adds the given sprite to the sprite set to render it in the next
+    /// frame, at a position in world coordinates. When the frame is
+    /// painted, the position is mapped to the window through the
+    /// [Camera] given to set_camera(Camera const&), and the sprite is
+    /// scaled and rotated with the camera's zoom and rotation. The
+    /// position need not be a whole number of pixels.
+    ///
+    /// Sprites added with add_sprite(Sprite const&, Posn<int>, int,
+    /// Transform const&) are not affected by the camera, so they can be
+    /// used for a score display or other overlay. Otherwise, this works
+    /// like that function.
+    ///
+    /// [Camera]: @ref ge211::geometry::Camera
+    Sprite_set& add_world_sprite(Sprite const& sprite,
+                                 Posn<double> xy,
+                                 int z = 0,
+                                 Transform const& transform = Transform());
+
+    /// Sets the camera that maps the positions of sprites added with
+    /// add_world_sprite to the window. The camera applies to all such
+    /// sprites in the frame, including those already added, and remains
+    /// in effect for later frames until it is changed again.
+    Sprite_set& set_camera(Camera const& camera)
+    {
+        camera_ = camera;
+        return *this;
+    }
+
+    /// Returns the camera given to set_camera(Camera const&).
+    Camera const& get_camera() const NOEXCEPT
+    { return camera_; }
+
 private:
     friend class detail::Engine;
+    friend Render_target_sprite;
 
     Sprite_set();
-    std::vector<detail::Placed_sprite> sprites_;
+
+    // Paints and then removes all the sprites, culling those outside
+    // `screen` if `cull` is true. Returns the number painted.
+    size_t paint_(detail::Renderer&, Dims<int> screen, bool cull);
+
+    detail::Placed_sprites sprites_;
+    Camera camera_;
+};
+
+namespace sprites {
+
+/// A sprite that caches the result of drawing other sprites. Use this
+/// for a part of the scene that is made of many sprites but rarely
+/// changes, such as a panel of buttons or a chunk of a tile map: rather
+/// than adding every piece to the @ref Sprite_set each frame, draw them
+/// once into a Render_target_sprite, and then add it as a single
+/// sprite.
+///
+/// To draw into a Render_target_sprite, call redraw(), which returns an
+/// empty @ref Sprite_set, and add sprites to that as you would in
+/// @ref Abstract_game::draw(Sprite_set&), with positions relative to the
+/// top-left corner of the Render_target_sprite. The sprites are painted
+/// into its texture the next time it is rendered, and the texture keeps
+/// the result until redraw() is called again. With some graphics
+/// drivers, the texture can lose its contents, for example when the
+/// display changes mode, in which case the sprites are painted again.
+///
+/// For example:
+///
+/// ```cpp
+/// struct My_game : Abstract_game
+/// {
+///     Render_target_sprite panel{{200, 600}};
+///     Rectangle_sprite button{{180, 40}, Color::medium_blue()};
+///
+///     void on_start() override
+///     {
+///         Sprite_set& contents = panel.redraw();
+///         for (int i = 0; i < 10; ++i)
+///             contents.add_sprite(button, {10, 10 + 60 * i});
+///     }
+///
+///     void draw(Sprite_set& set) override
+///     {
+///         set.add_sprite(panel, {600, 0});
+///     }
+/// };
+/// ```
+///
+/// \ownership
+///
+/// The sprites added to the Sprite_set returned by redraw() are
+/// borrowed, and must live until redraw() is called again or this
+/// Render_target_sprite is destroyed, since they may be painted again.
+class Render_target_sprite : public Sprite
+{
+public:
+    /// Constructs a Render_target_sprite with the given dimensions,
+    /// filled with `background`, which defaults to transparent.
+    ///
+    /// \preconditions
+    ///  - `dimensions` is positive in both dimensions; throws
+    ///    exceptions::Client_logic_error if violated.
+    explicit Render_target_sprite(Dims<int> dimensions,
+                                  Color background = Color(0, 0, 0, 0));
+
+    Dims<int> dimensions() const override;
+
+    /// Clears the contents and returns an empty @ref Sprite_set to add
+    /// the new contents to. The contents are painted the next time this
+    /// sprite is rendered.
+    Sprite_set& redraw();
+
+    /// Whether redraw() has been called since this sprite was last
+    /// rendered, so that rendering it will paint its contents.
+    bool is_dirty() const NOEXCEPT
+    { return dirty_; }
+
+private:
+    void render(detail::Renderer&, Posn<int>, Transform const&) const override;
+    void render_subpixel(detail::Renderer&, Posn<float>,
+                         Transform const&) const override;
+
+    // Creates the texture if need be, and paints the contents into it
+    // if dirty or if the renderer has lost it.
+    void update_(detail::Renderer&) const;
+
+    Dims<int> dimensions_;
+    Color background_;
+
+    // The texture can only be made once we have a renderer, and is
+    // repainted when rendered, so these change in const functions.
+    mutable detail::Texture texture_;
+    mutable Sprite_set contents_;
+    mutable bool dirty_ = true;
+    // The renderer's target generation when the texture was painted.
+    mutable unsigned long target_generation_ = 0;
 };
 
+} // end namespace sprites
+
 }
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "forward.hxx"
+#include "geometry.hxx"
+#include "doxygen.hxx"
+#include "render.hxx"
+#include "sprites.hxx"
+
+#include <cstdint>
+#include <vector>
+
+GE211_REGISTER_TYPE_NAME(ge211::Tile_map);
+
+namespace ge211 {
+
+namespace sprites {
+
+/// A grid of tiles, each drawn from a tileset, that renders as a single
+/// sprite. Use this for grid-based games, where adding a sprite for
+/// every visible tile every frame would be slow.
+///
+/// The tileset is a sprite, usually an @ref Image_sprite, made of equal
+/// tiles in rows. Tiles are numbered from 0 at the top left, across
+/// each row and then down, so in a tileset 8 tiles wide, tile 9 is the
+/// second tile of the second row. Each cell of the map holds the number
+/// of its tile, or Tile_map::no_tile to leave it empty.
+///
+/// To draw the map, add it to the @ref Sprite_set, with its position
+/// giving where its top-left corner appears; to scroll, add it at a
+/// different position, or use Sprite_set::add_world_sprite with a
+/// [Camera]. The map is divided into square chunks of chunk_tiles by
+/// chunk_tiles cells. Each chunk is painted once into its own texture,
+/// and painted again only when one of its cells changes, so each frame
+/// renders only a few textures covering the window. The scale of a
+/// [Transform] is applied to the whole map, but its rotation and flips
+/// are ignored.
+///
+/// \ownership
+///
+/// The tileset sprite is borrowed, and must outlive the Tile_map.
+///
+/// [Camera]: @ref ge211::geometry::Camera
+/// [Transform]: @ref ge211::geometry::Transform
+class Tile_map : public Sprite
+{
+public:
+    /// The number of a tile in the tileset.
+    using Tile = int;
+
+    /// The tile number of an empty cell, which shows whatever is
+    /// behind the map.
+    static constexpr Tile no_tile = -1;
+
+    /// The width and height of each chunk, in cells.
+    static constexpr int chunk_tiles = 32;
+
+    /// Constructs a map of the given dimensions, in cells, with every
+    /// cell empty. The tileset is cut into tiles of dimensions
+    /// `tile_dims`, in pixels.
+    ///
+    /// \preconditions
+    ///  - `tile_dims` and `map_dims` are positive in both dimensions,
+    ///    and `tile_dims` is no larger than the tileset; throws
+    ///    exceptions::Client_logic_error if violated.
+    Tile_map(Sprite const& tileset, Dims<int> tile_dims, Dims<int> map_dims);
+
+    /// The dimensions of the whole map, in pixels.
+    Dims<int> dimensions() const override;
+
+    /// The dimensions of the map, in cells.
+    Dims<int> map_dimensions() const NOEXCEPT
+    { return map_dims_; }
+
+    /// The dimensions of each tile, in pixels.
+    Dims<int> tile_dimensions() const NOEXCEPT
+    { return tile_dims_; }
+
+    /// The number of tiles in the tileset. Valid tile numbers are from
+    /// 0 to one less than this.
+    int tile_count() const NOEXCEPT
+    { return tileset_columns_ * tileset_rows_; }
+
+    /// Returns the tile in the given cell.
+    ///
+    /// \preconditions
+    ///  - `cell` is within the map; throws
+    ///    exceptions::Client_logic_error if violated.
+    Tile get_tile(Posn<int> cell) const;
+
+    /// Sets the tile in the given cell.
+    ///
+    /// \preconditions
+    ///  - `cell` is within the map, and `tile` is no_tile or less than
+    ///    tile_count(); throws exceptions::Client_logic_error if
+    ///    violated.
+    Tile_map& set_tile(Posn<int> cell, Tile tile);
+
+    /// Sets every cell to the given tile.
+    ///
+    /// \preconditions
+    ///  - `tile` is no_tile or less than tile_count(); throws
+    ///    exceptions::Client_logic_error if violated.
+    Tile_map& fill(Tile tile);
+
+private:
+    struct Chunk_
+    {
+        detail::Texture texture;
+        bool dirty = true;
+        // The value of render_count_ when this chunk was last rendered.
+        uint32_t last_rendered = 0;
+    };
+
+    void render(detail::Renderer&, Posn<int>, Transform const&) const override;
+    void render_subpixel(detail::Renderer&, Posn<float>,
+                         Transform const&) const override;
+
+    void render_chunks_(detail::Renderer&, Posn<float>,
+                        Transform const&) const;
+    void bake_(detail::Renderer&, Chunk_&, Posn<int> chunk) const;
+    void evict_unused_chunks_() const;
+
+    void check_tile_(Tile, char const* who) const;
+    size_t index_(Posn<int> cell, char const* who) const;
+
+    Sprite const& tileset_;
+    Dims<int> tile_dims_;
+    Dims<int> map_dims_;
+    Dims<int> chunk_grid_;
+    int tileset_columns_;
+    int tileset_rows_;
+
+    // The tile in each cell, row by row.
+    std::vector<Tile> tiles_;
+
+    // Textures are made and painted while rendering, so these change in
+    // const functions.
+    mutable detail::Texture tileset_texture_;
+    mutable std::vector<Chunk_> chunks_;
+    mutable size_t baked_chunks_ = 0;
+    mutable uint32_t render_count_ = 0;
+    // The renderer's target generation when the chunks were baked.
+    mutable unsigned long target_generation_ = 0;
+};
+
+} // end namespace sprites
+
+}
@@ -4,6 +4,7 @@
 #include "ge211/util/lazy_ptr.hxx"
 #include "ge211/util/name_of_type.hxx"
 #include "ge211/util/ring_buffer.hxx"
+#include "ge211/util/spsc_queue.hxx"
 #include "ge211/util/stringable.hxx"
 #include "ge211/util/to_string.hxx"
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <utility>
+
 namespace util {
 namespace pointers {
 
@@ -41,6 +44,17 @@ public:
         return std::addressof(operator*());
     }
 
+    /// Forces construction, passing the given arguments to the
+    /// constructor, and returns a reference to the value. If the value
+    /// has already been constructed then the arguments are ignored.
+    template <typename... ARGS>
+    reference force(ARGS&&... args) const
+    {
+        if (!ptr_)
+            ptr_.reset(new value_type(std::forward<ARGS>(args)...));
+        return *ptr_;
+    }
+
 private:
     mutable std::unique_ptr<value_type> ptr_;
 
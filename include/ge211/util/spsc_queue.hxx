@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace util {
+namespace containers {
+
+/// A fixed-capacity, lock-free queue for passing elements from one
+/// producer thread to one consumer thread.
+///
+/// `try_push` must only be called by the producer and `try_pop` only by
+/// the consumer, but the two may run concurrently. (Several threads may
+/// take turns being the producer, provided something else, such as a
+/// lock they all hold, keeps them from pushing at the same time.)
+template <typename Element, std::size_t Capacity>
+class Spsc_queue
+{
+    // One slot is left empty to distinguish full from empty.
+    using Buffer_ = std::array<Element, Capacity + 1>;
+
+public:
+    /// The type of the elements.
+    using value_type = Element;
+
+    /// The capacity of the queue.
+    static constexpr std::size_t capacity = Capacity;
+
+    /// Constructs an empty queue.
+    Spsc_queue()
+    { }
+
+    Spsc_queue(Spsc_queue const&) = delete;
+    Spsc_queue& operator=(Spsc_queue const&) = delete;
+
+    /// Enqueues an element, returning false if the queue is full.
+    /// Producer only.
+    bool
+    try_push(value_type value)
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t next = advance_(tail);
+
+        if (next == head_.load(std::memory_order_acquire))
+            return false;
+
+        buf_[tail] = std::move(value);
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /// Dequeues the oldest element into `out`, returning false if the
+    /// queue is empty. Consumer only.
+    bool
+    try_pop(value_type& out)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+
+        out = std::move(buf_[head]);
+        head_.store(advance_(head), std::memory_order_release);
+        return true;
+    }
+
+    /// Returns whether the queue is empty. Only a hint unless called by
+    /// the consumer while the producer is idle.
+    bool
+    empty() const
+    {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static std::size_t
+    advance_(std::size_t index)
+    {
+        return index == Capacity ? 0 : index + 1;
+    }
+
+    Buffer_ buf_;
+    std::atomic<std::size_t> head_{0};
+    std::atomic<std::size_t> tail_{0};
+};
+
+}  // end namespace containers
+}  // end namespace util
@@ -1,12 +1,23 @@
 #include "ge211/audio.hxx"
+#include "ge211/effect_cache.hxx"
+#include "ge211/hot_reload.hxx"
+#include "ge211/mixer_policy.hxx"
+#include "ge211/music_stream.hxx"
 #include "ge211/resource.hxx"
 #include "ge211/session.hxx"
+#include "ge211/software_mixer.hxx"
 
 #include <SDL.h>
 #include <SDL_mixer.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 namespace ge211 {
 
@@ -53,9 +64,22 @@ Music_track::Music_track(const std::string& filename, const Mixer& mixer)
 
 bool Music_track::real_try_load_(const std::string& filename, const Mixer&)
 {
-    Mix_Music* raw = Mix_LoadMUS_RW(File_resource(filename).release(), 1);
+    auto location = File_resource::locate(filename);
+
+    // Resources in the pack are already in memory, so there's nothing
+    // to read ahead.
+    std::shared_ptr<Music_stream> stream;
+    SDL_RWops* rw = nullptr;
+    if (location.path.compare(0, 5, "pack:") != 0)
+        rw = Music_stream::open(location.path, stream);
+    if (!rw)
+        rw = File_resource(filename).release();
+
+    Mix_Music* raw = Mix_LoadMUS_RW(rw, 1);
     if (raw) {
         ptr_ = {raw, &Mix_FreeMusic};
+        if (stream) stream->start_realtime();
+        stream_ = std::move(stream);
         return true;
     } else {
         return false;
@@ -65,6 +89,16 @@ bool Music_track::real_try_load_(const std::string& filename, const Mixer&)
 void Music_track::real_clear_()
 {
     ptr_ = nullptr;
+    stream_ = nullptr;
+}
+
+Music_track::Stream_stats Music_track::get_stream_stats() const
+{
+    if (!stream_) return {0, 0, 0};
+
+    return {stream_->buffered_bytes(),
+            stream_->capacity_bytes(),
+            stream_->underruns()};
 }
 
 bool Music_track::real_empty_() const
@@ -72,23 +106,119 @@ bool Music_track::real_empty_() const
     return ptr_ == nullptr;
 }
 
+namespace {
+
+// When hot reloading, remembers every chunk loaded for a Sound_effect
+// from each file, so that they can all be updated when the file changes.
+class Sound_registry
+{
+public:
+    void insert(std::string const& path,
+                std::shared_ptr<Mix_Chunk> const& chunk)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto& chunks = map_[path];
+        chunks.erase(std::remove_if(chunks.begin(), chunks.end(),
+                                    [](std::weak_ptr<Mix_Chunk> const& w) {
+                                        return w.expired();
+                                    }),
+                     chunks.end());
+
+        // Sound effects from the same file share a cached chunk, so it
+        // may be registered already.
+        for (auto const& each : chunks)
+            if (each.lock() == chunk) return;
+
+        chunks.push_back(chunk);
+    }
+
+    // Copies the samples of `fresh` into every live chunk loaded from
+    // `path`, first stopping any channels and software voices that are
+    // playing them. Must be called on the main thread.
+    void replace(std::string const& path, Mix_Chunk const& fresh)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto iter = map_.find(path);
+        if (iter == map_.end()) return;
+
+        int channel_count = Mix_AllocateChannels(-1);
+
+        for (auto const& weak : iter->second) {
+            auto chunk = weak.lock();
+            if (!chunk) continue;
+
+            auto buf = static_cast<Uint8*>(SDL_malloc(fresh.alen));
+            if (!buf) continue;
+            std::memcpy(buf, fresh.abuf, fresh.alen);
+
+            for (int channel = 0; channel < channel_count; ++channel) {
+                if (Mix_Playing(channel) &&
+                    Mix_GetChunk(channel) == chunk.get())
+                    Mix_HaltChannel(channel);
+            }
+
+            // The audio thread may still be mixing the old samples in a
+            // software voice, so they are freed only once it has
+            // stopped.
+            Software_mixer::stop_voices_using(chunk->abuf,
+                                              chunk->allocated != 0);
+            chunk->abuf      = buf;
+            chunk->alen      = fresh.alen;
+            chunk->allocated = 1;
+        }
+    }
+
+    static Sound_registry& instance()
+    {
+        static Sound_registry instance;
+        return instance;
+    }
+
+private:
+    Sound_registry() = default;
+
+    std::mutex lock_;
+    std::unordered_map<std::string,
+                       std::vector<std::weak_ptr<Mix_Chunk>>> map_;
+};
+
+}  // end anonymous namespace
+
 Sound_effect::Sound_effect(const std::string& filename, const Mixer& mixer)
 {
     load(filename, mixer);
 }
 
-bool Sound_effect::real_try_load_(const std::string& filename, const Mixer&)
+bool Sound_effect::real_try_load_(const std::string& filename,
+                                  const Mixer& mixer)
 {
-    Mix_Chunk* raw = Mix_LoadWAV_RW(File_resource(filename).release(), 1);
+    auto chunk = mixer.effect_cache_->load(filename);
+
+    if (chunk) {
+        ptr_ = std::move(chunk);
+
+        if (Resource_watcher::is_requested()) {
+            auto path = File_resource::locate(filename).path;
+            Sound_registry::instance().insert(path, ptr_);
+            Resource_watcher::track(path,
+                                    Resource_watcher::Kind::sound_effect);
+        }
 
-    if (raw) {
-        ptr_ = {raw, &Mix_FreeChunk};
         return true;
     } else {
         return false;
     }
 }
 
+void Sound_effect::set_max_instances(int max_instances)
+{
+    if (max_instances < 0)
+        throw Client_logic_error(
+                "Sound_effect::set_max_instances: must be non-negative");
+
+    max_instances_ = max_instances;
+}
+
 void Sound_effect::real_clear_()
 {
     ptr_ = nullptr;
@@ -99,19 +229,80 @@ bool Sound_effect::real_empty_() const
     return ptr_ == nullptr;
 }
 
+// Checks the configuration and fills in the default frequency.
+static Mixer::Config check_mixer_config(Mixer::Config config)
+{
+    auto is_power_of_two = [](int n) { return n > 0 && (n & (n - 1)) == 0; };
+
+    if (config.frequency < 0)
+        throw Client_logic_error(
+                "Mixer::Config: frequency must be non-negative");
+
+    if (config.frequency == 0)
+        config.frequency = MIX_DEFAULT_FREQUENCY;
+
+    if (config.output_channels < 1 || config.output_channels > 8)
+        throw Client_logic_error(
+                "Mixer::Config: output_channels must be from 1 to 8");
+
+    if (!is_power_of_two(config.buffer_frames))
+        throw Client_logic_error(
+                "Mixer::Config: buffer_frames must be a power of two");
+
+    if (config.effect_channels <= 0)
+        throw Client_logic_error(
+                "Mixer::Config: effect_channels must be positive");
+
+    if (config.software_voices < 0)
+        throw Client_logic_error(
+                "Mixer::Config: software_voices must be non-negative");
+
+    return config;
+}
+
 Mixer::Mixer()
-        : enabled_{0 == Mix_OpenAudio(MIX_DEFAULT_FREQUENCY,
+        : Mixer(Config{})
+{ }
+
+Mixer::Mixer(const Config& config)
+        : config_{check_mixer_config(config)}
+        , enabled_{0 == Mix_OpenAudio(config_.frequency,
                                       MIX_DEFAULT_FORMAT,
-                                      2,
-                                      4096)}
-        , channels_(MIX_CHANNELS)
-        , available_effect_channels_(MIX_CHANNELS)
+                                      config_.output_channels,
+                                      config_.buffer_frames)}
+        , channels_(config_.effect_channels)
+        , active_index_(config_.effect_channels, -1)
+        , effect_cache_(new Effect_cache)
 {
+    // Pushed in reverse so that channel 0 is allocated first.
+    for (int channel = config_.effect_channels - 1; channel >= 0; --channel)
+        free_channels_.push_back(channel);
+
     if (!enabled_) {
         warn_sdl() << "Could not open audio device";
         return;
     }
 
+    Mix_AllocateChannels(config_.effect_channels);
+    Mix_ChannelFinished(&on_channel_finished_);
+
+    int frequency, output_channels;
+    Uint16 format;
+    if (Mix_QuerySpec(&frequency, &format, &output_channels)) {
+        config_.frequency = frequency;
+        config_.output_channels = output_channels;
+        bytes_per_frame_ = SDL_AUDIO_BITSIZE(format) / 8 * output_channels;
+        software_mixer_supported_ = format == AUDIO_S16SYS &&
+                                    output_channels <= 2;
+    }
+
+    Mix_RegisterEffect(MIX_CHANNEL_POST, &observe_mix_, nullptr, this);
+
+    internal::logging::info()
+            << "Opened audio device at " << config_.frequency << " Hz with "
+            << config_.buffer_frames << "-frame buffer ("
+            << get_latency().milliseconds() << " ms)";
+
     int mix_want = MIX_INIT_OGG | MIX_INIT_MP3;
     int mix_have = Mix_Init(mix_want);
     if (mix_have == 0) {
@@ -135,13 +326,59 @@ Mixer::Mixer()
 
 Mixer::~Mixer()
 {
+    // Chunks must be freed before the audio device is closed.
+    software_mixer_.reset();
+    effect_cache_.reset();
+
     if (enabled_) {
+        Mix_UnregisterEffect(MIX_CHANNEL_POST, &observe_mix_);
+        Mix_ChannelFinished(nullptr);
         Mix_Quit();
         Mix_CloseAudio();
     }
 }
 
 
+static long long now_ns()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+            steady_clock::now().time_since_epoch()).count();
+}
+
+void Mixer::observe_mix_(int, void*, int len, void* self)
+{
+    auto& mixer = *static_cast<Mixer*>(self);
+    long long now = now_ns();
+
+    mixer.mix_buffer_bytes_.store(len, std::memory_order_relaxed);
+    if (mixer.mix_count_.load(std::memory_order_relaxed) == 0)
+        mixer.first_mix_ns_.store(now, std::memory_order_relaxed);
+    mixer.last_mix_ns_.store(now, std::memory_order_relaxed);
+    mixer.mix_count_.fetch_add(1, std::memory_order_release);
+}
+
+Duration Mixer::get_latency() const
+{
+    int frames = config_.buffer_frames;
+
+    int bytes = mix_buffer_bytes_.load(std::memory_order_relaxed);
+    if (bytes > 0 && bytes_per_frame_ > 0)
+        frames = bytes / bytes_per_frame_;
+
+    return Duration(frames / double(config_.frequency));
+}
+
+Duration Mixer::get_measured_mix_period() const
+{
+    long count = mix_count_.load(std::memory_order_acquire);
+    if (count < 2) return Duration(0);
+
+    long long first = first_mix_ns_.load(std::memory_order_relaxed);
+    long long last = last_mix_ns_.load(std::memory_order_relaxed);
+    return Duration((last - first) / 1e9 / double(count - 1));
+}
+
 void Mixer::play_music(Music_track music, bool forever)
 {
     attach_music(std::move(music));
@@ -179,10 +416,15 @@ void Mixer::resume_music(Duration fade_in, bool forever)
 
         case State::paused:
             Mix_RewindMusic();
-            Mix_FadeInMusicPos(current_music_.ptr_.get(),
-                               forever? -1 : 0,
-                               int(fade_in.milliseconds()),
-                               music_position_.elapsed_time().seconds());
+            if (Mix_FadeInMusicPos(current_music_.ptr_.get(),
+                                   forever? -1 : 0,
+                                   int(fade_in.milliseconds()),
+                                   music_position_.elapsed_time().seconds())
+                < 0) {
+                // Leave it paused, so that resuming again retries.
+                warn_sdl() << "Could not resume music";
+                break;
+            }
             music_position_.resume();
             music_state_ = State::playing;
             break;
@@ -249,20 +491,47 @@ Mixer::State Sound_effect_handle::get_state() const
 
 int Mixer::find_empty_channel_() const
 {
-    auto iter = std::find_if(channels_.begin(),
-                             channels_.end(),
-                             [](auto& h) { return h.empty(); });
+    return free_channels_.empty() ? -1 : free_channels_.back();
+}
 
-    if (iter == channels_.end())
-        return -1;
-    else
-        return (int) std::distance(channels_.begin(), iter);
+namespace {
+
+// Channels that SDL_mixer reports finished, waiting for the main thread
+// to unregister their effects. SDL_mixer calls the finished callback
+// either on the audio thread or, from Mix_HaltChannel, on the main
+// thread, but always with the audio device locked, so there is only
+// ever one producer at a time.
+util::containers::Spsc_queue<int, 1024> finished_channels;
+
+// Set if finished_channels overflows, in which case the next poll
+// checks every active channel.
+std::atomic<bool> finished_channels_overflowed{false};
+
+}  // end anonymous namespace
+
+void Mixer::on_channel_finished_(int channel)
+{
+    if (!finished_channels.try_push(channel))
+        finished_channels_overflowed.store(true, std::memory_order_relaxed);
+}
+
+void Mixer::release_finished_channel_(int channel)
+{
+    // The channel may have been stopped and reused by the main thread
+    // since it was reported finished, so check it's still done.
+    if (channel >= 0 && channel < int(channels_.size()) &&
+        channels_[channel] && !Mix_Playing(channel))
+    {
+        unregister_effect_(channel);
+    }
 }
 
 void Mixer::poll_channels_()
 {
     if (!enabled_) return;
 
+    effect_cache_->publish();
+
     if (current_music_) {
         if (!Mix_PlayingMusic()) {
             switch (music_state_) {
@@ -284,12 +553,117 @@ void Mixer::poll_channels_()
         }
     }
 
-    for (int channel = 0; channel < int(channels_.size()); ++channel) {
-        if (channels_[channel] && !Mix_Playing(channel))
-        {
-            unregister_effect_(channel);
+    int channel;
+    while (finished_channels.try_pop(channel))
+        release_finished_channel_(channel);
+
+    if (finished_channels_overflowed.exchange(false)) {
+        // Iterate over a copy, since unregistering modifies the set.
+        auto active = active_channels_;
+        for (int each : active)
+            release_finished_channel_(each);
+    }
+
+    update_positional_effects_();
+
+    if (software_mixer_) software_mixer_->collect_finished();
+}
+
+bool Mixer::apply_position_(const Sound_effect_handle& handle)
+{
+    auto& impl = *handle.ptr_;
+
+    auto panning = spatialize(listener_, impl.position, attenuation_);
+    if (!panning.audible) return false;
+
+    if (panning.left != impl.left || panning.right != impl.right) {
+        Mix_SetPanning(impl.channel, panning.left, panning.right);
+        impl.left = panning.left;
+        impl.right = panning.right;
+    }
+
+    return true;
+}
+
+void Mixer::update_positional_effects_()
+{
+    for (size_t i = 0; i < active_channels_.size(); ) {
+        int channel = active_channels_[i];
+        auto const& handle = channels_[channel];
+
+        if (!handle.ptr_->positional || apply_position_(handle)) {
+            ++i;
+            continue;
         }
+
+        // Out of earshot. Unregistering moves another channel into
+        // position i, so don't advance.
+        ++culled_effects_;
+        unregister_effect_(channel);
+        Mix_HaltChannel(channel);
+    }
+}
+
+Sound_effect_handle
+Mixer::play_effect_at(Sound_effect effect,
+                      Posn<double> position,
+                      double volume)
+{
+    if (!enabled_) {
+        throw Mixer_not_enabled_error{};
+    }
+
+    auto culled_before = culled_effects_;
+    auto handle = try_play_effect_at(std::move(effect), position, volume);
+    if (!handle && culled_effects_ == culled_before) {
+        throw Out_of_channels_error{};
+    }
+
+    return handle;
+}
+
+Sound_effect_handle
+Mixer::try_play_effect_at(Sound_effect effect,
+                          Posn<double> position,
+                          double volume)
+{
+    if (!enabled_) return {};
+
+    auto panning = spatialize(listener_, position, attenuation_);
+    if (!panning.audible) {
+        ++culled_effects_;
+        return {};
     }
+
+    int channel = allocate_channel_(effect);
+    if (channel < 0) return {};
+
+    Mix_Volume(channel, unit_to_volume(volume));
+    Mix_SetPanning(channel, panning.left, panning.right);
+    Mix_PlayChannel(channel, effect.ptr_.get(), 0);
+
+    auto handle = register_effect_(channel, std::move(effect));
+    auto& impl = *handle.ptr_;
+    impl.positional = true;
+    impl.position = position;
+    impl.left = panning.left;
+    impl.right = panning.right;
+    return handle;
+}
+
+void Mixer::set_attenuation(const Attenuation& attenuation)
+{
+    if (!(attenuation.reference_distance >= 0 &&
+          attenuation.reference_distance < attenuation.max_distance))
+        throw Client_logic_error(
+                "Mixer::set_attenuation: need 0 <= reference_distance"
+                " < max_distance");
+
+    if (!(attenuation.pan_distance > 0))
+        throw Client_logic_error(
+                "Mixer::set_attenuation: pan_distance must be positive");
+
+    attenuation_ = attenuation;
 }
 
 Sound_effect_handle
@@ -312,7 +686,7 @@ Mixer::try_play_effect(Sound_effect effect, double volume)
 {
     if (!enabled_) return {};
 
-    int channel = find_empty_channel_();
+    int channel = allocate_channel_(effect);
     if (channel < 0) return {};
 
     Mix_Volume(channel, unit_to_volume(volume));
@@ -321,6 +695,89 @@ Mixer::try_play_effect(Sound_effect effect, double volume)
     return register_effect_(channel, std::move(effect));
 }
 
+int Mixer::allocate_channel_(const Sound_effect& effect)
+{
+    Mix_Chunk const* chunk = effect.ptr_.get();
+
+    auto iter = instance_counts_.find(chunk);
+    bool over_limit = !within_instance_limit(
+            iter == instance_counts_.end() ? 0 : iter->second,
+            effect.max_instances_);
+
+    if (!over_limit) {
+        int channel = find_empty_channel_();
+        if (channel >= 0) return channel;
+    }
+
+    if (voice_stealing_ == Voice_stealing::none) return -1;
+
+    int victim = choose_victim_(effect.priority_,
+                                over_limit ? chunk : nullptr);
+    if (victim < 0) return -1;
+
+    // This pushes the victim's channel onto the free list, where
+    // find_empty_channel_() will find it.
+    unregister_effect_(victim);
+    Mix_HaltChannel(victim);
+
+    return find_empty_channel_();
+}
+
+int Mixer::choose_victim_(int priority, const Mix_Chunk* chunk) const
+{
+    std::vector<Steal_candidate> candidates;
+    candidates.reserve(active_channels_.size());
+
+    for (int channel : active_channels_) {
+        auto const& impl = *channels_[channel].ptr_;
+        int volume = voice_stealing_ == Voice_stealing::quietest ?
+                     Mix_Volume(channel, -1) : 0;
+        candidates.push_back({channel, impl.effect.priority_, volume,
+                              impl.serial, impl.effect.ptr_.get()});
+    }
+
+    return choose_victim(voice_stealing_, candidates, priority, chunk);
+}
+
+int Mixer::get_effect_channel_count() const
+{
+    return int(channels_.size());
+}
+
+void Mixer::set_effect_channel_count(int count)
+{
+    if (count <= 0)
+        throw Client_logic_error(
+                "Mixer::set_effect_channel_count: must be positive");
+
+    int old_count = int(channels_.size());
+
+    for (int channel = count; channel < old_count; ++channel) {
+        if (channels_[channel]) {
+            unregister_effect_(channel);
+            Mix_HaltChannel(channel);
+        }
+    }
+
+    if (enabled_) Mix_AllocateChannels(count);
+
+    free_channels_.erase(
+            std::remove_if(free_channels_.begin(), free_channels_.end(),
+                           [=](int channel) { return channel >= count; }),
+            free_channels_.end());
+
+    // New channels go under the existing free ones, so that lower
+    // channels keep being allocated first.
+    std::vector<int> added;
+    for (int channel = count - 1; channel >= old_count; --channel)
+        added.push_back(channel);
+    free_channels_.insert(free_channels_.begin(),
+                          added.begin(), added.end());
+
+    channels_.resize(count);
+    active_index_.resize(count, -1);
+}
+
 void Sound_effect_handle::resume()
 {
     switch (ptr_->state) {
@@ -386,8 +843,9 @@ void Mixer::pause_all_effects()
 {
     Mix_Pause(-1);
 
-    for (const auto& handle : channels_) {
-        if (handle && handle.ptr_->state == State::playing)
+    for (int channel : active_channels_) {
+        auto const& handle = channels_[channel];
+        if (handle.ptr_->state == State::playing)
             handle.ptr_->state = State::paused;
     }
 }
@@ -396,23 +854,48 @@ void Mixer::resume_all_effects()
 {
     Mix_Resume(-1);
 
-    for (const auto& handle : channels_) {
-        if (handle && handle.ptr_->state == State::paused)
+    for (int channel : active_channels_) {
+        auto const& handle = channels_[channel];
+        if (handle.ptr_->state == State::paused)
             handle.ptr_->state = State::playing;
     }
 }
 
+void Mixer::preload_effect(const std::string& filename)
+{
+    if (enabled_) effect_cache_->preload(filename);
+}
+
+Mixer::Effect_cache_stats Mixer::effect_cache_stats() const
+{
+    effect_cache_->publish();
+    return effect_cache_->stats();
+}
+
+void Mixer::evict_unused_effects()
+{
+    effect_cache_->publish();
+    effect_cache_->evict_unused();
+}
+
 int Mixer::available_effect_channels() const
 {
-    return available_effect_channels_;
+    return int(free_channels_.size());
 }
 
 Sound_effect_handle
 Mixer::register_effect_(int channel, Sound_effect effect)
 {
     assert(!channels_[channel]);
-    channels_[channel] = Sound_effect_handle(*this, std::move(effect), channel);
-    --available_effect_channels_;
+    assert(!free_channels_.empty() && free_channels_.back() == channel);
+
+    free_channels_.pop_back();
+    active_index_[channel] = int(active_channels_.size());
+    active_channels_.push_back(channel);
+    ++instance_counts_[effect.ptr_.get()];
+
+    channels_[channel] = Sound_effect_handle(*this, std::move(effect),
+                                             channel, ++effects_started_);
     return channels_[channel];
 }
 
@@ -420,8 +903,63 @@ void Mixer::unregister_effect_(int channel)
 {
     assert(channels_[channel]);
     channels_[channel].ptr_->state = State::detached;
+
+    auto count = instance_counts_.find(
+            channels_[channel].ptr_->effect.ptr_.get());
+    if (--count->second == 0) instance_counts_.erase(count);
+
     channels_[channel] = {};
-    ++available_effect_channels_;
+
+    // Swap-remove from the active set.
+    int index = active_index_[channel];
+    int last = active_channels_.back();
+    active_channels_[index] = last;
+    active_index_[last] = index;
+    active_channels_.pop_back();
+    active_index_[channel] = -1;
+
+    free_channels_.push_back(channel);
+}
+
+Software_mixer* Mixer::start_software_mixer_()
+{
+    if (!software_mixer_ && enabled_ && software_mixer_supported_ &&
+        config_.software_voices > 0)
+    {
+        software_mixer_.reset(new Software_mixer(config_.output_channels,
+                                                 config_.frequency,
+                                                 config_.software_voices));
+    }
+
+    return software_mixer_.get();
+}
+
+Voice Mixer::play_voice(Sound_effect effect,
+                        double gain,
+                        double pan,
+                        double pitch,
+                        bool loop)
+{
+    if (gain < 0)
+        throw Client_logic_error("Mixer::play_voice: gain is negative");
+    if (pan < -1 || pan > 1)
+        throw Client_logic_error("Mixer::play_voice: pan out of range");
+    if (!(pitch > 0))
+        throw Client_logic_error("Mixer::play_voice: pitch not positive");
+
+    Software_mixer* stage = start_software_mixer_();
+    if (!stage) return {};
+
+    auto id = stage->play(std::move(effect.ptr_),
+                          float(gain), float(pan), float(pitch), loop);
+    if (!id) return {};
+
+    return Voice(*this, id);
+}
+
+int Mixer::get_voice_count() const
+{
+    return software_mixer_ ? int(software_mixer_->voice_count()) : 0;
 }
 
 double Mixer::get_music_volume() const
@@ -446,8 +984,10 @@ Sound_effect_handle::operator bool() const
 
 Sound_effect_handle::Sound_effect_handle(Mixer& mixer,
                                          Sound_effect effect,
-                                         int channel)
-        : ptr_(std::make_shared<Impl_>(mixer, std::move(effect), channel))
+                                         int channel,
+                                         unsigned long serial)
+        : ptr_(std::make_shared<Impl_>(mixer, std::move(effect),
+                                       channel, serial))
 { }
 
 double Sound_effect_handle::get_volume() const
@@ -464,6 +1004,85 @@ void Sound_effect_handle::set_volume(double unit_value)
         Mix_Volume(ptr_->channel, unit_to_volume(unit_value));
 }
 
+bool Sound_effect_handle::is_positional() const
+{
+    return ptr_->positional;
+}
+
+Posn<double> Sound_effect_handle::get_position() const
+{
+    return ptr_->position;
+}
+
+void Sound_effect_handle::set_position(Posn<double> position)
+{
+    ptr_->positional = true;
+    ptr_->position = position;
+}
+
+bool Voice::is_playing() const
+{
+    auto const& stage = mixer_->software_mixer_;
+    return stage && stage->is_live(id_);
+}
+
+void Voice::set_gain(double gain, Duration ramp)
+{
+    if (gain < 0)
+        throw Client_logic_error("Voice::set_gain: gain is negative");
+
+    auto const& stage = mixer_->software_mixer_;
+    if (!stage) return;
+
+    long ramp_frames = std::lround(ramp.seconds() * stage->frequency());
+    stage->set_gain(id_, float(gain), ramp_frames);
+}
+
+void Voice::set_pan(double pan)
+{
+    if (pan < -1 || pan > 1)
+        throw Client_logic_error("Voice::set_pan: pan out of range");
+
+    if (auto const& stage = mixer_->software_mixer_)
+        stage->set_pan(id_, float(pan));
+}
+
+void Voice::set_pitch(double pitch)
+{
+    if (!(pitch > 0))
+        throw Client_logic_error("Voice::set_pitch: pitch not positive");
+
+    if (auto const& stage = mixer_->software_mixer_)
+        stage->set_pitch(id_, float(pitch));
+}
+
+void Voice::stop()
+{
+    if (auto const& stage = mixer_->software_mixer_)
+        stage->stop(id_);
+}
+
 } // end namespace audio
 
+namespace detail {
+
+Resource_watcher::Action reload_sound_effect(std::string const& path)
+{
+    std::shared_ptr<Mix_Chunk> fresh(
+            Mix_LoadWAV_RW(SDL_RWFromFile(path.c_str(), "rb"), 1),
+            &Mix_FreeChunk);
+
+    if (!fresh) {
+        internal::logging::warn()
+                << "Hot reload: could not decode sound " << path;
+        return {};
+    }
+
+    return [=] {
+        audio::Sound_registry::instance().replace(path, *fresh);
+    };
+}
+
+} // end namespace detail
+
 } // end namespace ge211
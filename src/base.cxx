@@ -23,6 +23,11 @@ std::string Abstract_game::initial_window_title() const
     return default_window_title;
 }
 
+Mixer::Config Abstract_game::initial_mixer_config() const
+{
+    return Mixer::Config{};
+}
+
 void Abstract_game::run()
 {
     Engine(*this).run();
@@ -41,6 +46,16 @@ Window& Abstract_game::get_window() const
                              "until engine is initialized"};
 }
 
+size_t Abstract_game::get_drawn_sprite_count() const NOEXCEPT
+{
+    return engine_ ? engine_->drawn_sprite_count() : 0;
+}
+
+size_t Abstract_game::get_culled_sprite_count() const NOEXCEPT
+{
+    return engine_ ? engine_->culled_sprite_count() : 0;
+}
+
 void Abstract_game::prepare(const sprites::Sprite& sprite) const
 {
     if (engine_)
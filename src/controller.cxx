@@ -0,0 +1,214 @@
+#include "ge211/controller.hxx"
+#include "ge211/error.hxx"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ge211 {
+
+namespace events {
+
+constexpr size_t Controller_state::button_count;
+constexpr size_t Controller_state::axis_count;
+
+} // end namespace events
+
+namespace detail {
+
+// Our enumerations follow SDL's, so that we can index by them. Newer
+// SDLs add more buttons (the paddles, the touchpad, and so on) after
+// ours, and we ignore those.
+static_assert(Controller_state::button_count <= SDL_CONTROLLER_BUTTON_MAX,
+              "Controller_button must begin SDL_GameControllerButton");
+static_assert(Controller_state::axis_count == SDL_CONTROLLER_AXIS_MAX,
+              "Controller_axis must match SDL_GameControllerAxis");
+
+constexpr size_t Controller_tracker::max_controllers;
+
+Dims<float> apply_stick_deadzone(Dims<float> stick, float deadzone) NOEXCEPT
+{
+    float magnitude = std::sqrt(stick.width * stick.width +
+                                stick.height * stick.height);
+
+    if (magnitude <= deadzone) return {0, 0};
+
+    float scaled = (std::min(magnitude, 1.f) - deadzone) / (1 - deadzone);
+    return stick * (scaled / magnitude);
+}
+
+float apply_trigger_deadzone(float trigger, float deadzone) NOEXCEPT
+{
+    if (trigger <= deadzone) return 0;
+    return (std::min(trigger, 1.f) - deadzone) / (1 - deadzone);
+}
+
+namespace {
+
+// Converts a raw axis value to the range -1 to 1. SDL reports -32768
+// to 32767, so the negative end is clamped.
+float normalize_axis(int16_t value) NOEXCEPT
+{
+    return std::max(-1.f, value / 32767.f);
+}
+
+}  // end anonymous namespace
+
+Controller_tracker::~Controller_tracker()
+{
+    for (size_t i = 0; i < max_controllers; ++i)
+        close_(i);
+}
+
+void Controller_tracker::device_added(int device_index)
+{
+    if (!SDL_IsGameController(device_index)) return;
+
+    SDL_GameController* handle = SDL_GameControllerOpen(device_index);
+    if (!handle) {
+        internal::logging::warn()
+                << "Could not open game controller: " << SDL_GetError();
+        return;
+    }
+
+    auto id = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(handle));
+
+    // SDL reports controllers that were connected at startup as added,
+    // so one may already be open. Opening it again took another
+    // reference, which we give back.
+    for (size_t i = 0; i < max_controllers; ++i) {
+        if (handles_[i] && instance_ids_[i] == id) {
+            SDL_GameControllerClose(handle);
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < max_controllers; ++i) {
+        if (!handles_[i]) {
+            handles_[i]      = handle;
+            instance_ids_[i] = id;
+            states_[i]       = Controller_state{};
+            states_[i].connected_ = true;
+            return;
+        }
+    }
+
+    internal::logging::info()
+            << "Ignoring game controller because "
+            << max_controllers << " are already connected";
+    SDL_GameControllerClose(handle);
+}
+
+void Controller_tracker::device_removed(int32_t instance_id)
+{
+    for (size_t i = 0; i < max_controllers; ++i) {
+        if (handles_[i] && instance_ids_[i] == instance_id)
+            close_(i);
+    }
+}
+
+void Controller_tracker::update()
+{
+    // Have SDL read the devices, in case events weren't pumped.
+    SDL_GameControllerUpdate();
+
+    for (size_t i = 0; i < max_controllers; ++i) {
+        SDL_GameController* handle = handles_[i];
+
+        // A controller unplugged since the last frame releases its
+        // buttons now.
+        if (!handle) {
+            update(i, Buttons{}, Axes{});
+            continue;
+        }
+
+        Buttons buttons;
+        for (size_t b = 0; b < Controller_state::button_count; ++b) {
+            auto button = SDL_GameControllerButton(b);
+            buttons[b] = SDL_GameControllerGetButton(handle, button) != 0;
+        }
+
+        Axes axes;
+        for (size_t a = 0; a < Controller_state::axis_count; ++a) {
+            auto axis = SDL_GameControllerAxis(a);
+            axes[a] = SDL_GameControllerGetAxis(handle, axis);
+        }
+
+        update(i, buttons, axes);
+    }
+}
+
+void Controller_tracker::update(size_t index,
+                                Buttons const& buttons,
+                                Axes const& axes) NOEXCEPT
+{
+    Controller_state& state = states_[index];
+
+    state.pressed_  = buttons & ~state.down_;
+    state.released_ = state.down_ & ~buttons;
+    state.down_     = buttons;
+
+    auto stick = [&](Controller_axis x, Controller_axis y) {
+        Dims<float> raw{normalize_axis(axes[size_t(x)]),
+                        normalize_axis(axes[size_t(y)])};
+        Dims<float> result = apply_stick_deadzone(raw, deadzone_.stick);
+        state.axes_[size_t(x)] = result.width;
+        state.axes_[size_t(y)] = result.height;
+    };
+
+    auto trigger = [&](Controller_axis t) {
+        float raw = normalize_axis(axes[size_t(t)]);
+        state.axes_[size_t(t)] = apply_trigger_deadzone(raw,
+                                                        deadzone_.trigger);
+    };
+
+    stick(Controller_axis::left_x, Controller_axis::left_y);
+    stick(Controller_axis::right_x, Controller_axis::right_y);
+    trigger(Controller_axis::left_trigger);
+    trigger(Controller_axis::right_trigger);
+}
+
+bool Controller_tracker::rumble(size_t index, float low, float high,
+                                Duration duration)
+{
+    if (index >= max_controllers || !handles_[index]) return false;
+
+    auto to_strength = [](float f) {
+        return Uint16(std::lround(std::max(0.f, std::min(1.f, f)) * 0xFFFF));
+    };
+
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+    auto millis = Uint32(std::max(0L, duration.milliseconds()));
+
+    return SDL_GameControllerRumble(handles_[index], to_strength(low),
+                                    to_strength(high), millis) == 0;
+#else
+    (void) to_strength;
+    (void) low;
+    (void) high;
+    (void) duration;
+    return false;
+#endif
+}
+
+Controller_state const&
+Controller_tracker::state(size_t index) const NOEXCEPT
+{
+    static Controller_state const disconnected;
+    return index < max_controllers ? states_[index] : disconnected;
+}
+
+void Controller_tracker::close_(size_t index) NOEXCEPT
+{
+    if (handles_[index]) {
+        SDL_GameControllerClose(handles_[index]);
+        handles_[index] = nullptr;
+    }
+
+    states_[index].connected_ = false;
+}
+
+} // end namespace detail
+
+}
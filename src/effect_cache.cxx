@@ -0,0 +1,202 @@
+#include "ge211/effect_cache.hxx"
+
+#include <SDL_mixer.h>
+
+#include <algorithm>
+
+namespace ge211 {
+
+namespace detail {
+
+static Effect_cache::Chunk_ptr decode_effect(std::string const& filename)
+{
+    return Effect_cache::Chunk_ptr(
+            Mix_LoadWAV_RW(File_resource(filename).release(), 1),
+            &Mix_FreeChunk);
+}
+
+Effect_cache::Effect_cache()
+        : Effect_cache(&File_resource::locate, &decode_effect)
+{ }
+
+Effect_cache::Effect_cache(Locator locate, Decoder decode)
+        : locate_{std::move(locate)},
+          decode_{std::move(decode)}
+{ }
+
+Effect_cache::~Effect_cache()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    job_ready_.notify_all();
+
+    for (auto& worker : workers_) worker.join();
+}
+
+bool
+Effect_cache::find_(Resource_location const& location, Chunk_ptr& out) const
+{
+    auto iter = map_.find(location.path);
+    if (iter == map_.end() || iter->second.mtime != location.mtime)
+        return false;
+
+    out = iter->second.chunk;
+    return true;
+}
+
+Effect_cache::Chunk_ptr
+Effect_cache::load(std::string const& filename)
+{
+    auto location = locate_(filename);
+    Chunk_ptr result;
+
+    publish();
+    if (find_(location, result)) {
+        ++hits_;
+        return result;
+    }
+
+    {
+        std::unique_lock<std::mutex> guard(lock_);
+
+        if (in_flight_.count(location.path)) {
+            auto job = std::find_if(jobs_.begin(), jobs_.end(),
+                                    [&](Job_ const& j) {
+                                        return j.location.path ==
+                                               location.path;
+                                    });
+
+            if (job != jobs_.end()) {
+                // Not started yet, so do it ourselves rather than wait
+                // for the rest of the queue.
+                jobs_.erase(job);
+                in_flight_.erase(location.path);
+            } else {
+                job_done_.wait(guard, [&] {
+                    return in_flight_.count(location.path) == 0;
+                });
+            }
+        }
+    }
+
+    publish();
+    if (find_(location, result)) {
+        ++hits_;
+        return result;
+    }
+
+    ++misses_;
+    result = decode_(filename);
+    if (result) map_[location.path] = {location.mtime, result};
+    return result;
+}
+
+void Effect_cache::preload(std::string const& filename)
+{
+    auto location = locate_(filename);
+
+    publish();
+    Chunk_ptr ignored;
+    if (find_(location, ignored)) return;
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+
+        // A worker may have finished it since we published.
+        for (auto const& result : finished_)
+            if (result.first.path == location.path) return;
+
+        if (!in_flight_.insert(location.path).second) return;
+        jobs_.push_back({filename, location});
+
+        // Workers are started as needed, up to the limit.
+        unsigned limit = std::min(unsigned(max_workers),
+                                  std::thread::hardware_concurrency());
+        if (workers_.size() < std::max(limit, 1u))
+            workers_.emplace_back([this] { work_(); });
+    }
+
+    job_ready_.notify_one();
+}
+
+void Effect_cache::work_()
+{
+    std::unique_lock<std::mutex> guard(lock_);
+
+    for (;;) {
+        job_ready_.wait(guard, [&] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) return;
+
+        Job_ job = std::move(jobs_.front());
+        jobs_.pop_front();
+
+        guard.unlock();
+        Chunk_ptr chunk;
+        try {
+            chunk = decode_(job.filename);
+        } catch (Exception_base const&) {
+            // The file went away after preload() found it.
+        }
+        guard.lock();
+
+        finished_.emplace_back(job.location, std::move(chunk));
+        in_flight_.erase(job.location.path);
+        job_done_.notify_all();
+    }
+}
+
+void Effect_cache::publish()
+{
+    std::vector<std::pair<Resource_location, Chunk_ptr>> finished;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        finished.swap(finished_);
+    }
+
+    for (auto& result : finished) {
+        ++misses_;
+
+        if (result.second) {
+            map_[result.first.path] = {result.first.mtime, result.second};
+        } else {
+            internal::logging::warn()
+                    << "Could not preload sound effect "
+                    << result.first.path;
+        }
+    }
+}
+
+Mixer::Effect_cache_stats Effect_cache::stats() const
+{
+    Mixer::Effect_cache_stats result{map_.size(), 0, 0, hits_, misses_};
+
+    for (auto const& entry : map_)
+        result.pcm_bytes += entry.second.chunk->alen;
+
+    std::lock_guard<std::mutex> guard(lock_);
+    result.pending = in_flight_.size() + finished_.size();
+
+    return result;
+}
+
+void Effect_cache::evict_unused()
+{
+    for (auto iter = map_.begin(); iter != map_.end(); ) {
+        if (iter->second.chunk.use_count() > 1)
+            ++iter;
+        else
+            iter = map_.erase(iter);
+    }
+}
+
+void Effect_cache::clear()
+{
+    map_.clear();
+}
+
+} // end namespace detail
+
+} // end namespace ge211
@@ -27,7 +27,8 @@ Engine::Engine(Abstract_game& game)
                   game_.initial_window_title(),
                   game_.initial_window_dimensions(),
           },
-          renderer_{window_}
+          renderer_{window_},
+          has_controllers_{SDL_WasInit(SDL_INIT_GAMECONTROLLER) != 0}
 {
     game_.engine_ = this;
 }
@@ -70,6 +71,7 @@ Engine::State_::run_cycle()
     clock.mark_frame();
     auto frame_length = game.clock_.prev_frame_length();
 
+    engine.resource_watcher_.apply_pending();
     engine.handle_events_(event);
     game.on_frame(frame_length.seconds());
 
@@ -90,10 +92,17 @@ Engine::State_::run_cycle()
 
     if (frame_length < allowed_frame_length) {
         auto duration = allowed_frame_length - frame_length;
-        duration.sleep_for_();
+        engine.wait_pumping_events_(duration);
         internal::logging::debug()
                 << "Software vsync slept for "
                 << duration.seconds() << " s";
+    } else {
+        // The frame has used up its budget, so there's no time left to
+        // wait. That is the usual case with hardware vsync, where
+        // present() does the waiting. Pump anyway, so that events that
+        // arrived while we were drawing are stamped now rather than
+        // after present(), which may block and can't pump.
+        SDL_PumpEvents();
     }
 
     clock.mark_present();
@@ -120,16 +129,56 @@ Engine::run()
     }
 }
 
+void
+Engine::wait_pumping_events_(Duration duration)
+{
+    // SDL stamps events when they're pumped from the operating system,
+    // and only the thread that created the window may pump them, so we
+    // pump here rather than sleeping through the whole wait. That way
+    // events that arrive during the wait get accurate timestamps.
+    static const Duration slice = Duration(0.001);
+
+    auto deadline = Time_point::now() + duration;
+
+    for (;;) {
+        SDL_PumpEvents();
+
+        auto remaining = deadline - Time_point::now();
+        if (remaining <= Duration()) break;
+
+        std::min(remaining, slice).sleep_for_();
+    }
+}
+
 void
 Engine::handle_events_(SDL_Event& e)
 {
+    auto& input = game_.input_;
+    bool callbacks = game_.input_mode_ == Input_mode::callbacks;
+
+    input.begin_frame();
+
+    // SDL timestamps are in milliseconds since SDL started; we convert
+    // them to Time_points relative to now.
+    auto now = Time_point::now();
+    auto ticks = SDL_GetTicks();
+    auto time_of = [=](Uint32 timestamp) {
+        auto age = Sint32(ticks - timestamp);
+        return now - Duration(std::max(age, Sint32(0)) / 1000.0);
+    };
+
     while (SDL_PollEvent(&e) != 0) {
+        auto time = time_of(e.common.timestamp);
+
         switch (e.type) {
         case SDL_QUIT:
             game_.quit();
             break;
 
         case SDL_TEXTINPUT: {
+            input.text_input(e.text.text);
+            if (!callbacks) break;
+
             const char *str = e.text.text;
             const char *end = str + std::strlen(str);
 
@@ -143,6 +192,9 @@ Engine::handle_events_(SDL_Event& e)
 
         case SDL_KEYDOWN: {
             Key key(e.key);
+            input.key_down(key, e.key.repeat != 0, time);
+            if (!callbacks) break;
+
             if (!e.key.repeat) {
                 game_.on_key_down(key);
             }
@@ -152,14 +204,19 @@ Engine::handle_events_(SDL_Event& e)
             break;
         }
 
-        case SDL_KEYUP:
-            game_.on_key_up(Key{e.key});
+        case SDL_KEYUP: {
+            Key key(e.key);
+            input.key_up(key, time);
+            if (callbacks) game_.on_key_up(key);
             break;
+        }
 
         case SDL_MOUSEBUTTONDOWN: {
             Mouse_button button;
             if (map_button(e.button.button, button)) {
-                game_.on_mouse_down(button, {e.button.x, e.button.y});
+                input.mouse_down(button, {e.button.x, e.button.y}, time);
+                if (callbacks)
+                    game_.on_mouse_down(button, {e.button.x, e.button.y});
             }
             break;
         }
@@ -167,13 +224,25 @@ Engine::handle_events_(SDL_Event& e)
         case SDL_MOUSEBUTTONUP: {
             Mouse_button button;
             if (map_button(e.button.button, button)) {
-                game_.on_mouse_up(button, {e.button.x, e.button.y});
+                input.mouse_up(button, {e.button.x, e.button.y}, time);
+                if (callbacks)
+                    game_.on_mouse_up(button, {e.button.x, e.button.y});
             }
             break;
         }
 
         case SDL_MOUSEMOTION:
-            game_.on_mouse_move({e.motion.x, e.motion.y});
+            input.mouse_move({e.motion.x, e.motion.y},
+                             {e.motion.xrel, e.motion.yrel});
+            if (callbacks) game_.on_mouse_move({e.motion.x, e.motion.y});
+            break;
+
+        case SDL_CONTROLLERDEVICEADDED:
+            game_.controllers_.device_added(e.cdevice.which);
+            break;
+
+        case SDL_CONTROLLERDEVICEREMOVED:
+            game_.controllers_.device_removed(e.cdevice.which);
             break;
 
         case SDL_WINDOWEVENT:
@@ -190,26 +259,28 @@ Engine::handle_events_(SDL_Event& e)
             }
             break;
 
+        case SDL_RENDER_TARGETS_RESET:
+            renderer_.targets_reset();
+            break;
+
         default:;
         }
     }
+
+    // Controller buttons and axes aren't handled as events, but read all
+    // at once.
+    if (has_controllers_) game_.controllers_.update();
 }
 
 void
 Engine::paint_sprites_(Sprite_set& sprite_set)
 {
-    auto& vec = sprite_set.sprites_;
-    auto begin = vec.begin(),
-            end = vec.end();
-
-    std::make_heap(begin, end);
-
-    while (begin != end) {
-        std::pop_heap(begin, end--);
-        end->render(renderer_);
-    }
+    size_t total = sprite_set.sprites_.size();
 
-    vec.clear();
+    drawn_sprites_  = sprite_set.paint_(renderer_,
+                                        window_.get_dimensions(),
+                                        game_.sprite_culling_);
+    culled_sprites_ = total - drawn_sprites_;
 }
 
 Window&
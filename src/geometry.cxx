@@ -1,172 +1,194 @@
 #include "ge211/geometry.hxx"
 
+#include <algorithm>
 #include <cmath>
 
 namespace ge211 {
 
 namespace geometry {
 
-Transform::Transform() NOEXCEPT
-        : rotation_{0},
-          scale_x_{1.0},
-          scale_y_{1.0},
-          flip_h_{false},
-          flip_v_{false}
-{ }
-
 Transform
 Transform::rotation(double degrees) NOEXCEPT
 {
     return Transform().set_rotation(degrees);
 }
 
-Transform
-Transform::flip_h() NOEXCEPT
+Transform&
+Transform::set_rotation(double rotation) NOEXCEPT
 {
-    return Transform().set_flip_h(true);
+    while (rotation < 0) { rotation += 360; }
+    rotation_ = std::fmod(rotation, 360);
+    return *this;
 }
 
 Transform
-Transform::flip_v() NOEXCEPT
+Transform::inverse() const NOEXCEPT
 {
-    return Transform().set_flip_v(true);
+    Transform result;
+    result.set_rotation(360 - rotation_);
+    result.set_flip_h(flip_h_);
+    result.set_flip_v(flip_v_);
+    result.set_scale_x(1 / scale_x_);
+    result.set_scale_y(1 / scale_y_);
+    return result;
 }
 
 Transform
-Transform::scale(double factor) NOEXCEPT
+Transform::operator*(Transform const& that) const NOEXCEPT
 {
-    return Transform().set_scale(factor);
+    return Transform{}
+            .set_rotation(get_rotation() + that.get_rotation())
+            .set_flip_h(get_flip_h() ^ that.get_flip_h())
+            .set_flip_v(get_flip_v() ^ that.get_flip_v())
+            .set_scale_x(get_scale_x() * that.get_scale_x())
+            .set_scale_y(get_scale_y() * that.get_scale_y());
 }
 
-Transform
-Transform::scale_x(double factor) NOEXCEPT
-{
-    return Transform().set_scale_x(factor);
-}
 
-Transform
-Transform::scale_y(double factor) NOEXCEPT
-{
-    return Transform().set_scale_y(factor);
-}
+Camera::Camera() NOEXCEPT
+        : position_{0, 0},
+          zoom_{1},
+          rotation_{0}
+{ }
 
-Transform&
-Transform::set_rotation(double rotation) NOEXCEPT
+Camera&
+Camera::set_position(Posn<double> position) NOEXCEPT
 {
-    while (rotation < 0) { rotation += 360; }
-    rotation_ = std::fmod(rotation, 360);
+    position_ = position;
     return *this;
 }
 
-Transform&
-Transform::set_flip_h(bool flip_h) NOEXCEPT
+Camera&
+Camera::set_zoom(double zoom) NOEXCEPT
 {
-    flip_h_ = flip_h;
+    zoom_ = zoom;
     return *this;
 }
 
-Transform&
-Transform::set_flip_v(bool flip_v) NOEXCEPT
+Camera&
+Camera::set_rotation(double rotation) NOEXCEPT
 {
-    flip_v_ = flip_v;
+    while (rotation < 0) { rotation += 360; }
+    rotation_ = std::fmod(rotation, 360);
     return *this;
 }
 
-Transform&
-Transform::set_scale(double scale) NOEXCEPT
-{
-    scale_x_ = scale;
-    scale_y_ = scale;
-    return *this;
-}
+namespace {
 
-Transform&
-Transform::set_scale_x(double scale_x) NOEXCEPT
+// Rotates a displacement clockwise (since y increases downward) by the
+// given angle in degrees.
+Dims<double> rotate(Dims<double> d, double degrees) NOEXCEPT
 {
-    scale_x_ = scale_x;
-    return *this;
-}
+    if (degrees == 0) return d;
 
-Transform&
-Transform::set_scale_y(double scale_y) NOEXCEPT
-{
-    scale_y_ = scale_y;
-    return *this;
+    double radians = degrees * 3.14159265358979323846 / 180;
+    double c = std::cos(radians);
+    double s = std::sin(radians);
+    return {d.width * c - d.height * s, d.width * s + d.height * c};
 }
 
-double
-Transform::get_rotation() const NOEXCEPT
-{
-    return rotation_;
 }
 
-bool
-Transform::get_flip_h() const NOEXCEPT
+Posn<double>
+Camera::to_screen(Posn<double> world, Dims<int> window) const NOEXCEPT
 {
-    return flip_h_;
+    Dims<double> pivot = Dims<double>(window) / 2;
+    Dims<double> offset = world - position_ - pivot;
+    return Posn<double>(the_origin) + pivot +
+           rotate(offset * zoom_, rotation_);
 }
 
-bool
-Transform::get_flip_v() const NOEXCEPT
+Posn<double>
+Camera::to_world(Posn<double> screen, Dims<int> window) const NOEXCEPT
 {
-    return flip_v_;
+    Dims<double> pivot = Dims<double>(window) / 2;
+    Dims<double> offset = screen - Posn<double>(the_origin) - pivot;
+    return position_ + pivot + rotate(offset, -rotation_) / zoom_;
 }
-
-double
-Transform::get_scale_x() const NOEXCEPT
-{
-    return scale_x_;
 }
 
-double
-Transform::get_scale_y() const NOEXCEPT
-{
-    return scale_y_;
-}
+namespace detail {
 
-bool
-Transform::is_identity() const NOEXCEPT
+Rect<double> transformed_bounds(Posn<double> xy,
+                                Dims<int> dims,
+                                Transform const& transform) NOEXCEPT
 {
-    return *this == Transform();
-}
+    double width  = dims.width * std::abs(transform.get_scale_x());
+    double height = dims.height * std::abs(transform.get_scale_y());
 
-Transform
-Transform::inverse() const NOEXCEPT
-{
-    Transform result;
-    result.set_rotation(360 - rotation_);
-    result.set_flip_h(flip_h_);
-    result.set_flip_v(flip_v_);
-    result.set_scale_x(1 / scale_x_);
-    result.set_scale_y(1 / scale_y_);
-    return result;
-}
+    double rotation = transform.get_rotation();
+    if (rotation == 0) return {xy.x, xy.y, width, height};
 
-Transform
-Transform::operator*(Transform const& that) const NOEXCEPT
-{
-    return Transform{}
-            .set_rotation(get_rotation() + that.get_rotation())
-            .set_flip_h(get_flip_h() ^ that.get_flip_h())
-            .set_flip_v(get_flip_v() ^ that.get_flip_v())
-            .set_scale_x(get_scale_x() * that.get_scale_x())
-            .set_scale_y(get_scale_y() * that.get_scale_y());
+    double radians = rotation * 3.14159265358979323846 / 180;
+    double c = std::abs(std::cos(radians));
+    double s = std::abs(std::sin(radians));
+
+    double bound_width  = width * c + height * s;
+    double bound_height = width * s + height * c;
+
+    return {xy.x + (width - bound_width) / 2,
+            xy.y + (height - bound_height) / 2,
+            bound_width,
+            bound_height};
 }
 
-bool
-Transform::operator==(Transform const& that) const NOEXCEPT
+void transformed_bounds(Posn<double> const* xys,
+                        Dims<int> const* dims,
+                        Transform const* transforms,
+                        Rect<double>* result,
+                        size_t count) NOEXCEPT
 {
-    return get_rotation() == that.get_rotation() &&
-           get_flip_h() == that.get_flip_h() &&
-           get_flip_v() == that.get_flip_v() &&
-           get_scale_x() == that.get_scale_x() &&
-           get_scale_y() == that.get_scale_y();
+    // We work in blocks, first gathering each rectangle's scaled size
+    // and the sine and cosine of its rotation, which need a branch and
+    // a library call, into arrays. Then the arithmetic that finds the
+    // bounds is the same for every rectangle, so the compiler can
+    // vectorize it.
+    size_t const block = 64;
+    double width[block], height[block], c[block], s[block];
+
+    for (size_t start = 0; start < count; start += block) {
+        size_t n = std::min(block, count - start);
+
+        for (size_t i = 0; i < n; ++i) {
+            Transform const& transform = transforms[start + i];
+            width[i]  = dims[start + i].width *
+                        std::abs(transform.get_scale_x());
+            height[i] = dims[start + i].height *
+                        std::abs(transform.get_scale_y());
+
+            double rotation = transform.get_rotation();
+            if (rotation == 0) {
+                c[i] = 1;
+                s[i] = 0;
+            } else {
+                double radians = rotation * 3.14159265358979323846 / 180;
+                c[i] = std::abs(std::cos(radians));
+                s[i] = std::abs(std::sin(radians));
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            double bound_width  = width[i] * c[i] + height[i] * s[i];
+            double bound_height = width[i] * s[i] + height[i] * c[i];
+
+            Rect<double>& out = result[start + i];
+            out.x      = xys[start + i].x + (width[i] - bound_width) / 2;
+            out.y      = xys[start + i].y + (height[i] - bound_height) / 2;
+            out.width  = bound_width;
+            out.height = bound_height;
+        }
+    }
 }
 
-bool
-Transform::operator!=(Transform const& that) const NOEXCEPT
+void compose_transforms(Transform* transforms,
+                        uint32_t const* indices,
+                        size_t count,
+                        Transform const& parent) NOEXCEPT
 {
-    return !(operator==(that));
+    for (size_t i = 0; i < count; ++i) {
+        Transform& transform = transforms[indices[i]];
+        transform = transform * parent;
+    }
 }
 
 }
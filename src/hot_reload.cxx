@@ -0,0 +1,292 @@
+#include "ge211/hot_reload.hxx"
+#include "ge211/error.hxx"
+#include "ge211/resource.hxx"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+  #include <dirent.h>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <sys/inotify.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace ge211 {
+
+namespace detail {
+
+namespace {
+
+// Paths of loaded resources, and what kind of resource each is.
+class Tracked_paths
+{
+public:
+    void insert(std::string const& path, Resource_watcher::Kind kind)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        map_[path] = kind;
+    }
+
+    bool find(std::string const& path, Resource_watcher::Kind& out) const
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto iter = map_.find(path);
+        if (iter == map_.end()) return false;
+        out = iter->second;
+        return true;
+    }
+
+    static Tracked_paths& instance()
+    {
+        static Tracked_paths instance;
+        return instance;
+    }
+
+private:
+    Tracked_paths() = default;
+
+    mutable std::mutex lock_;
+    std::unordered_map<std::string, Resource_watcher::Kind> map_;
+};
+
+Resource_watcher::Action
+prepare_reload_(std::string const& path)
+{
+    Resource_watcher::Kind kind;
+    if (!Tracked_paths::instance().find(path, kind))
+        return {};
+
+    switch (kind) {
+    case Resource_watcher::Kind::image:
+        return reload_image(path);
+    case Resource_watcher::Kind::sound_effect:
+        return reload_sound_effect(path);
+    case Resource_watcher::Kind::font:
+        return reload_font(path);
+    }
+
+    return {};
+}
+
+}  // end anonymous namespace
+
+bool Resource_watcher::is_requested()
+{
+    static bool const result = [] {
+        char const* value = std::getenv("GE211_HOT_RELOAD");
+        return value && *value && std::strcmp(value, "0") != 0;
+    }();
+    return result;
+}
+
+void Resource_watcher::track(std::string const& path, Kind kind)
+{
+    if (is_requested() && path.compare(0, 5, "pack:") != 0)
+        Tracked_paths::instance().insert(path, kind);
+}
+
+#ifdef __linux__
+
+struct Resource_watcher::Impl_
+{
+    ~Impl_();
+
+    bool start();
+    void run();
+    void watch_tree(std::string const& dir);
+    void read_events(std::set<std::string>& changed);
+
+    // How long to wait for more changes before reloading, since editors
+    // often save a file in several steps.
+    static int const settle_ms = 50;
+
+    int inotify_fd = -1;
+    int stop_pipe[2] = {-1, -1};
+    std::unordered_map<int, std::string> watched_dirs;
+    std::thread thread;
+
+    std::mutex lock;
+    std::vector<Action> pending;
+};
+
+Resource_watcher::Impl_::~Impl_()
+{
+    if (thread.joinable()) {
+        char byte = 0;
+        (void) !::write(stop_pipe[1], &byte, 1);
+        thread.join();
+    }
+
+    if (inotify_fd >= 0) ::close(inotify_fd);
+    if (stop_pipe[0] >= 0) ::close(stop_pipe[0]);
+    if (stop_pipe[1] >= 0) ::close(stop_pipe[1]);
+}
+
+bool Resource_watcher::Impl_::start()
+{
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) return false;
+
+    if (pipe2(stop_pipe, O_CLOEXEC) != 0) return false;
+
+    for (auto const& prefix : File_resource::search_directories())
+        watch_tree(prefix);
+
+    if (watched_dirs.empty()) return false;
+
+    internal::logging::info()
+            << "Hot reload: watching " << watched_dirs.size()
+            << " resource directories";
+
+    thread = std::thread([this] { run(); });
+    return true;
+}
+
+void Resource_watcher::Impl_::watch_tree(std::string const& dir)
+{
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+    int wd = inotify_add_watch(inotify_fd, dir.c_str(), mask);
+    if (wd < 0) return;
+
+    watched_dirs[wd] = dir;
+
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) return;
+
+    while (dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+
+        std::string path = dir + name;
+
+        // lstat, so that a link to a directory, which might be an
+        // ancestor, isn't followed, as in scan_resource_directories.
+        struct stat info;
+        if (lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+            watch_tree(path + "/");
+    }
+
+    closedir(handle);
+}
+
+void Resource_watcher::Impl_::read_events(std::set<std::string>& changed)
+{
+    alignas(inotify_event) char buf[4096];
+
+    for (;;) {
+        ssize_t len = ::read(inotify_fd, buf, sizeof buf);
+        if (len <= 0) return;
+
+        for (char* p = buf; p < buf + len; ) {
+            auto* event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            auto dir = watched_dirs.find(event->wd);
+            if (dir == watched_dirs.end() || event->len == 0) continue;
+
+            std::string path = dir->second + event->name;
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    watch_tree(path + "/");
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                changed.insert(path);
+            }
+        }
+    }
+}
+
+void Resource_watcher::Impl_::run()
+{
+    pollfd fds[2] = {
+            {inotify_fd, POLLIN, 0},
+            {stop_pipe[0], POLLIN, 0},
+    };
+
+    std::set<std::string> changed;
+
+    for (;;) {
+        int timeout = changed.empty() ? -1 : settle_ms;
+        int ready = poll(fds, 2, timeout);
+
+        if (ready < 0 && errno != EINTR) return;
+        if (fds[1].revents) return;
+
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            read_events(changed);
+            continue;
+        }
+
+        // Quiet for settle_ms, so reload everything that changed.
+        for (auto const& path : changed) {
+            Action action = prepare_reload_(path);
+            if (!action) continue;
+
+            std::lock_guard<std::mutex> guard(lock);
+            pending.push_back(std::move(action));
+        }
+
+        changed.clear();
+    }
+}
+
+Resource_watcher::Resource_watcher()
+{
+    if (!is_requested()) return;
+
+    impl_.reset(new Impl_);
+
+    if (!impl_->start()) {
+        internal::logging::warn()
+                << "Hot reload: could not watch resource directories";
+        impl_.reset();
+    }
+}
+
+void Resource_watcher::apply_pending()
+{
+    if (!impl_) return;
+
+    std::vector<Action> actions;
+    {
+        std::lock_guard<std::mutex> guard(impl_->lock);
+        actions.swap(impl_->pending);
+    }
+
+    for (auto& action : actions) action();
+}
+
+#else // not __linux__
+
+struct Resource_watcher::Impl_
+{ };
+
+Resource_watcher::Resource_watcher()
+{
+    if (is_requested()) {
+        internal::logging::warn()
+                << "Hot reload is not supported on this platform";
+    }
+}
+
+void Resource_watcher::apply_pending()
+{ }
+
+#endif // __linux__
+
+Resource_watcher::~Resource_watcher()
+{ }
+
+} // end namespace detail
+
+}
@@ -0,0 +1,100 @@
+#include "ge211/input.hxx"
+
+namespace ge211 {
+
+namespace events {
+
+constexpr size_t Input_state::key_slots;
+
+size_t Input_state::slot_(Key key) NOEXCEPT
+{
+    switch (key.type()) {
+    case Key::Type::code:
+        return key.code() < 128 ? size_t(key.code()) : key_slots;
+    case Key::Type::other:
+        return key_slots;
+    default:
+        return 128 + size_t(key.type()) - 1;
+    }
+}
+
+} // end namespace events
+
+namespace detail {
+
+void Input_tracker::begin_frame() NOEXCEPT
+{
+    state_.keys_pressed_.reset();
+    state_.keys_released_.reset();
+    state_.pressed_keys_.clear();
+    state_.released_keys_.clear();
+    state_.text_.clear();
+
+    state_.buttons_pressed_.reset();
+    state_.buttons_released_.reset();
+    state_.mouse_motion_ = {0, 0};
+    state_.events_.clear();
+}
+
+void Input_tracker::key_down(Key key, bool repeat, Time_point time)
+{
+    if (repeat) return;
+
+    size_t slot = Input_state::slot_(key);
+    if (slot < Input_state::key_slots) {
+        state_.keys_down_.set(slot);
+        state_.keys_pressed_.set(slot);
+    }
+
+    state_.pressed_keys_.push_back(key);
+    state_.events_.push_back({Input_event::Type::key_down, key,
+                              Mouse_button::left, {0, 0}, time});
+}
+
+void Input_tracker::key_up(Key key, Time_point time)
+{
+    size_t slot = Input_state::slot_(key);
+    if (slot < Input_state::key_slots) {
+        state_.keys_down_.reset(slot);
+        state_.keys_released_.set(slot);
+    }
+
+    state_.released_keys_.push_back(key);
+    state_.events_.push_back({Input_event::Type::key_up, key,
+                              Mouse_button::left, {0, 0}, time});
+}
+
+void Input_tracker::text_input(char const* utf8)
+{
+    state_.text_ += utf8;
+}
+
+void Input_tracker::mouse_down(Mouse_button button, Posn<int> posn,
+                               Time_point time)
+{
+    state_.buttons_down_.set(size_t(button));
+    state_.buttons_pressed_.set(size_t(button));
+    state_.mouse_position_ = posn;
+    state_.events_.push_back({Input_event::Type::mouse_down, Key{},
+                              button, posn, time});
+}
+
+void Input_tracker::mouse_up(Mouse_button button, Posn<int> posn,
+                             Time_point time)
+{
+    state_.buttons_down_.reset(size_t(button));
+    state_.buttons_released_.set(size_t(button));
+    state_.mouse_position_ = posn;
+    state_.events_.push_back({Input_event::Type::mouse_up, Key{},
+                              button, posn, time});
+}
+
+void Input_tracker::mouse_move(Posn<int> posn, Dims<int> relative) NOEXCEPT
+{
+    state_.mouse_position_ = posn;
+    state_.mouse_motion_ += relative;
+}
+
+} // end namespace detail
+
+}
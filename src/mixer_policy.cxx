@@ -0,0 +1,75 @@
+#include "ge211/mixer_policy.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace ge211 {
+
+namespace detail {
+
+Spatial_panning spatialize(Posn<double> listener,
+                           Posn<double> emitter,
+                           Mixer::Attenuation const& attenuation) NOEXCEPT
+{
+    double dx = emitter.x - listener.x;
+    double dy = emitter.y - listener.y;
+    double distance = std::sqrt(dx * dx + dy * dy);
+
+    // At the maximum distance the gain is already 0, so cull there too
+    // rather than mixing silence.
+    if (distance >= attenuation.max_distance) return {false, 0, 0};
+
+    double gain = 1;
+    if (distance > attenuation.reference_distance)
+        gain = (attenuation.max_distance - distance) /
+               (attenuation.max_distance - attenuation.reference_distance);
+
+    // Constant-power panning, scaled so that a centered effect is at
+    // full volume in both channels, and capped at full volume.
+    double pan = std::max(-1.0, std::min(1.0, dx / attenuation.pan_distance));
+    double angle = (pan + 1) * std::atan(1.0);
+    double left = std::min(1.0, std::sqrt(2.0) * std::cos(angle));
+    double right = std::min(1.0, std::sqrt(2.0) * std::sin(angle));
+
+    return {true,
+            uint8_t(std::lround(255 * gain * left)),
+            uint8_t(std::lround(255 * gain * right))};
+}
+
+bool within_instance_limit(int playing, int max_instances) NOEXCEPT
+{
+    return max_instances <= 0 || playing < max_instances;
+}
+
+int choose_victim(Mixer::Voice_stealing policy,
+                  std::vector<Steal_candidate> const& candidates,
+                  int priority,
+                  void const* samples) NOEXCEPT
+{
+    if (policy == Mixer::Voice_stealing::none) return -1;
+
+    bool by_volume = policy == Mixer::Voice_stealing::quietest;
+    Steal_candidate const* best = nullptr;
+
+    for (auto const& each : candidates) {
+        if (each.priority > priority) continue;
+        if (samples && each.samples != samples) continue;
+
+        if (!best ||
+            std::make_tuple(each.priority,
+                            by_volume ? each.volume : 0,
+                            each.serial) <
+            std::make_tuple(best->priority,
+                            by_volume ? best->volume : 0,
+                            best->serial)) {
+            best = &each;
+        }
+    }
+
+    return best ? best->channel : -1;
+}
+
+} // end namespace detail
+
+} // end namespace ge211
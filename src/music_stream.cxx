@@ -0,0 +1,447 @@
+#include "ge211/music_stream.hxx"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace ge211 {
+
+namespace detail {
+
+// The reader thread's state is the file and the write end of the ring.
+// The decoder's state, which only the thread currently decoding (the
+// main thread while loading, and then the audio thread) touches, is its
+// position and the read end of the ring.
+//
+// To move the reader, the decoder sets requested_offset, bumps
+// requested_gen, and carries on without waiting; the reader
+// acknowledges by setting acked_gen. Until then the ring's contents
+// belong to the old position and the decoder doesn't read them.
+//
+// Once the stream is real-time, the decoder runs in the audio callback,
+// so it never takes a lock or waits: if the bytes it wants aren't
+// buffered yet, it gets zeros in their place and counts an underrun,
+// and the real bytes are dropped when they arrive. (A short read won't
+// do, since decoders take it for the end of the file.) It wakes the
+// reader with a semaphore, since posting one doesn't block. The reader
+// does its I/O holding no lock, and sleeps on the semaphore whenever
+// there's nothing to do, including at the end of the file.
+//
+// A seek that moves the reader waits, briefly, for it to catch up.
+// Seeks come from the main thread, while loading and when the music is
+// rewound or resumed, so there the wait keeps the reads that follow
+// from all being padded.
+struct Music_stream::Impl_
+{
+    Impl_();
+    ~Impl_();
+
+    void stop_reader();
+    void wake_reader();
+    void run_reader();
+    bool acked() const;
+    size_t available() const;
+    void restart_at(Sint64 offset);
+    void wait_for_reader();
+    Sint64 seek(Sint64 target);
+    size_t read(char* dst, size_t want);
+
+    // The start of the file, which is kept in memory.
+    static constexpr size_t head_bytes = 64 * 1024;
+    // The read-ahead buffer.
+    static constexpr size_t ring_bytes = 256 * 1024;
+    // How much the reader reads at a time.
+    static constexpr size_t block_bytes = 16 * 1024;
+    // The longest a seek waits for the reader, in milliseconds.
+    static constexpr int seek_wait_ms = 100;
+
+    std::FILE* file = nullptr;
+    Sint64 size = 0;
+    std::vector<char> head;
+
+    // One byte is left empty to distinguish full from empty.
+    std::vector<char> ring = std::vector<char>(ring_bytes + 1);
+    std::atomic<size_t> read_index{0};
+    std::atomic<size_t> write_index{0};
+    // Set when the reader reaches the end of the file.
+    std::atomic<bool> at_eof{false};
+    // Set when reading the file fails; cleared by the next restart.
+    std::atomic<bool> failed{false};
+
+    // Decoder only:
+    Sint64 position = 0;
+    // The file offset of the byte at read_index. This is behind
+    // `position` when reads were padded while the reader caught up.
+    Sint64 ring_position = 0;
+    unsigned long pending_gen = 0;
+
+    // Set once loading is done and the decoder runs on the audio thread.
+    std::atomic<bool> realtime{false};
+
+    std::atomic<Sint64> requested_offset{0};
+    std::atomic<unsigned long> requested_gen{0};
+    std::atomic<unsigned long> acked_gen{0};
+    std::atomic<bool> stopping{false};
+    SDL_sem* wakeup;
+
+    std::atomic<unsigned long> underruns{0};
+
+    std::thread thread;
+};
+
+constexpr size_t Music_stream::Impl_::head_bytes;
+constexpr size_t Music_stream::Impl_::ring_bytes;
+constexpr size_t Music_stream::Impl_::block_bytes;
+constexpr int Music_stream::Impl_::seek_wait_ms;
+
+Music_stream::Impl_::Impl_()
+        : wakeup(SDL_CreateSemaphore(0))
+{ }
+
+Music_stream::Impl_::~Impl_()
+{
+    stop_reader();
+    if (wakeup) SDL_DestroySemaphore(wakeup);
+    if (file) std::fclose(file);
+}
+
+void Music_stream::Impl_::stop_reader()
+{
+    if (thread.joinable()) {
+        stopping.store(true, std::memory_order_release);
+        wake_reader();
+        thread.join();
+    }
+}
+
+void Music_stream::Impl_::wake_reader()
+{
+    SDL_SemPost(wakeup);
+}
+
+bool Music_stream::Impl_::acked() const
+{
+    return acked_gen.load(std::memory_order_acquire) == pending_gen;
+}
+
+size_t Music_stream::Impl_::available() const
+{
+    // Each side acquires the other's index, so that neither touches
+    // bytes until the other is done with them.
+    size_t r = read_index.load(std::memory_order_acquire);
+    size_t w = write_index.load(std::memory_order_acquire);
+    return w >= r ? w - r : ring.size() - r + w;
+}
+
+void Music_stream::Impl_::run_reader()
+{
+    while (!stopping.load(std::memory_order_acquire)) {
+        unsigned long gen = requested_gen.load(std::memory_order_acquire);
+
+        if (gen != acked_gen.load(std::memory_order_relaxed)) {
+            // The decoder isn't reading the ring, so we can empty it.
+            Sint64 offset = requested_offset.load(std::memory_order_relaxed);
+            bool ok = std::fseek(file, long(offset), SEEK_SET) == 0;
+            write_index.store(read_index.load(std::memory_order_acquire),
+                              std::memory_order_relaxed);
+            at_eof.store(false, std::memory_order_relaxed);
+            failed.store(!ok, std::memory_order_relaxed);
+            acked_gen.store(gen, std::memory_order_release);
+        }
+
+        size_t space = ring_bytes - available();
+
+        if (at_eof.load(std::memory_order_relaxed) ||
+            failed.load(std::memory_order_relaxed) ||
+            space < block_bytes)
+        {
+            // Wait for the decoder to make room or move us, or for
+            // stop_reader.
+            SDL_SemWait(wakeup);
+            continue;
+        }
+
+        size_t w = write_index.load(std::memory_order_relaxed);
+        size_t want = std::min(block_bytes, ring.size() - w);
+        size_t got = std::fread(ring.data() + w, 1, want, file);
+
+        if (got > 0) {
+            w += got;
+            if (w == ring.size()) w = 0;
+            write_index.store(w, std::memory_order_release);
+        }
+
+        if (got < want) {
+            if (std::ferror(file))
+                failed.store(true, std::memory_order_release);
+            else
+                at_eof.store(true, std::memory_order_release);
+        }
+    }
+}
+
+void Music_stream::Impl_::restart_at(Sint64 offset)
+{
+    requested_offset.store(offset, std::memory_order_relaxed);
+    pending_gen = requested_gen.load(std::memory_order_relaxed) + 1;
+    requested_gen.store(pending_gen, std::memory_order_release);
+    wake_reader();
+    ring_position = offset;
+}
+
+void Music_stream::Impl_::wait_for_reader()
+{
+    using clock = std::chrono::steady_clock;
+    auto deadline = clock::now() + std::chrono::milliseconds(seek_wait_ms);
+    size_t first = size_t(std::min(Sint64(block_bytes),
+                                   size - ring_position));
+
+    while (clock::now() < deadline) {
+        if (acked() && (available() >= first ||
+                        at_eof.load(std::memory_order_acquire) ||
+                        failed.load(std::memory_order_acquire)))
+            return;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+Sint64 Music_stream::Impl_::seek(Sint64 target)
+{
+    target = std::max(Sint64(0), std::min(size, target));
+    if (target == position) return target;
+
+    Sint64 head_end = Sint64(head.size());
+    Sint64 ring_start = std::max(target, head_end);
+
+    if (acked() && ring_position <= ring_start &&
+        ring_start <= ring_position + Sint64(available()))
+    {
+        // Skip forward within the ring.
+        size_t skip = size_t(ring_start - ring_position);
+        size_t r = read_index.load(std::memory_order_relaxed);
+        read_index.store((r + skip) % ring.size(), std::memory_order_release);
+        ring_position = ring_start;
+        wake_reader();
+    } else {
+        restart_at(ring_start);
+        wait_for_reader();
+    }
+
+    position = target;
+    return target;
+}
+
+size_t Music_stream::Impl_::read(char* dst, size_t want)
+{
+    size_t done = 0;
+    bool consumed = false;
+
+    while (done < want && position < size) {
+        if (position < Sint64(head.size())) {
+            size_t n = std::min(want - done, head.size() - size_t(position));
+            std::memcpy(dst + done, head.data() + position, n);
+            position += Sint64(n);
+            done += n;
+            continue;
+        }
+
+        if (acked() && ring_position < position) {
+            // Drop bytes that padding already stood in for.
+            size_t stale = size_t(std::min(position - ring_position,
+                                           Sint64(available())));
+            size_t r = read_index.load(std::memory_order_relaxed);
+            read_index.store((r + stale) % ring.size(),
+                             std::memory_order_release);
+            ring_position += Sint64(stale);
+            consumed = consumed || stale > 0;
+        }
+
+        size_t n = acked() && ring_position == position
+                   ? std::min(want - done, available()) : 0;
+
+        if (n > 0) {
+            size_t r = read_index.load(std::memory_order_relaxed);
+            size_t first = std::min(n, ring.size() - r);
+            std::memcpy(dst + done, ring.data() + r, first);
+            std::memcpy(dst + done + first, ring.data(), n - first);
+            read_index.store((r + n) % ring.size(), std::memory_order_release);
+
+            position += Sint64(n);
+            ring_position += Sint64(n);
+            done += n;
+            consumed = true;
+            continue;
+        }
+
+        if (acked() && available() == 0) {
+            if (failed.load(std::memory_order_acquire)) {
+                SDL_SetError("Music_stream: could not read file");
+                break;
+            }
+
+            // The file ended early, perhaps because it was truncated.
+            if (at_eof.load(std::memory_order_acquire)) break;
+        }
+
+        // The audio thread mustn't wait, and a short read would look
+        // like the end of the file, so pad with zeros. That's silence
+        // for PCM, and a damaged frame that compressed decoders skip;
+        // either is better than holding up every other sound.
+        if (realtime.load(std::memory_order_relaxed)) {
+            size_t pad = size_t(std::min(Sint64(want - done),
+                                         size - position));
+            std::memset(dst + done, 0, pad);
+            position += Sint64(pad);
+            done += pad;
+            underruns.fetch_add(1, std::memory_order_relaxed);
+
+            // If the reader is far behind, skip it ahead rather than
+            // have it read bytes only to drop them.
+            if (position - ring_position > Sint64(ring_bytes))
+                restart_at(position);
+            break;
+        }
+
+        // While loading, on the main thread, waiting is fine.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Let the reader know there's room.
+    if (consumed) wake_reader();
+
+    return done;
+}
+
+Music_stream::Music_stream(std::unique_ptr<Impl_> impl)
+        : impl_(std::move(impl))
+{ }
+
+Music_stream::~Music_stream()
+{ }
+
+Owned<SDL_RWops>
+Music_stream::open(std::string const& path,
+                   std::shared_ptr<Music_stream>& stream)
+{
+    std::unique_ptr<Impl_> impl(new Impl_);
+
+    if (!impl->wakeup) return nullptr;
+
+    impl->file = std::fopen(path.c_str(), "rb");
+    if (!impl->file) return nullptr;
+
+    if (std::fseek(impl->file, 0, SEEK_END) != 0) return nullptr;
+    impl->size = std::ftell(impl->file);
+    if (impl->size < 0) return nullptr;
+    std::rewind(impl->file);
+
+    impl->head.resize(std::min(size_t(impl->size), Impl_::head_bytes));
+    if (std::fread(impl->head.data(), 1, impl->head.size(), impl->file) !=
+        impl->head.size())
+        return nullptr;
+
+    impl->ring_position = Sint64(impl->head.size());
+
+    SDL_RWops* rw = SDL_AllocRW();
+    if (!rw) return nullptr;
+
+    auto* self = impl.get();
+    stream.reset(new Music_stream(std::move(impl)));
+    self->thread = std::thread([self] { self->run_reader(); });
+
+    rw->size  = &size_;
+    rw->seek  = &seek_;
+    rw->read  = &read_;
+    rw->write = &write_;
+    rw->close = &close_;
+    rw->type  = SDL_RWOPS_UNKNOWN;
+    rw->hidden.unknown.data1 = new std::shared_ptr<Music_stream>(stream);
+
+    return rw;
+}
+
+void Music_stream::start_realtime() NOEXCEPT
+{
+    impl_->realtime.store(true, std::memory_order_relaxed);
+}
+
+size_t Music_stream::buffered_bytes() const NOEXCEPT
+{
+    size_t r = impl_->read_index.load(std::memory_order_relaxed);
+    size_t w = impl_->write_index.load(std::memory_order_relaxed);
+    return w >= r ? w - r : impl_->ring.size() - r + w;
+}
+
+size_t Music_stream::capacity_bytes() const NOEXCEPT
+{
+    return Impl_::ring_bytes;
+}
+
+unsigned long Music_stream::underruns() const NOEXCEPT
+{
+    return impl_->underruns.load(std::memory_order_relaxed);
+}
+
+Music_stream::Impl_& Music_stream::impl_of_(SDL_RWops* rw)
+{
+    auto stream = static_cast<std::shared_ptr<Music_stream>*>(
+            rw->hidden.unknown.data1);
+    return *(*stream)->impl_;
+}
+
+Sint64 Music_stream::size_(SDL_RWops* rw)
+{
+    return impl_of_(rw).size;
+}
+
+Sint64 Music_stream::seek_(SDL_RWops* rw, Sint64 offset, int whence)
+{
+    auto& impl = impl_of_(rw);
+
+    switch (whence) {
+    case RW_SEEK_SET:
+        return impl.seek(offset);
+    case RW_SEEK_CUR:
+        return impl.seek(impl.position + offset);
+    case RW_SEEK_END:
+        return impl.seek(impl.size + offset);
+    default:
+        return SDL_SetError("Music_stream: bad whence");
+    }
+}
+
+size_t Music_stream::read_(SDL_RWops* rw, void* ptr, size_t size,
+                           size_t count)
+{
+    if (size == 0) return 0;
+    auto& impl = impl_of_(rw);
+    return impl.read(static_cast<char*>(ptr), size * count) / size;
+}
+
+size_t Music_stream::write_(SDL_RWops*, void const*, size_t, size_t)
+{
+    SDL_SetError("Music_stream: read only");
+    return 0;
+}
+
+int Music_stream::close_(SDL_RWops* rw)
+{
+    // The Music_track may still hold the stream for its statistics, but
+    // nothing will read from it again.
+    impl_of_(rw).stop_reader();
+    delete static_cast<std::shared_ptr<Music_stream>*>(
+            rw->hidden.unknown.data1);
+    SDL_FreeRW(rw);
+    return 0;
+}
+
+} // end namespace detail
+
+}
@@ -0,0 +1,209 @@
+#include "ge211/pack.hxx"
+#include "ge211/error.hxx"
+
+#include <algorithm>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <tuple>
+
+namespace ge211 {
+
+namespace detail {
+
+namespace {
+
+char const pack_magic[8] = {'G', 'E', '2', '1', '1', 'P', 'K', '\0'};
+uint32_t const pack_version = 1;
+size_t const header_size = sizeof pack_magic + 4 + 4;
+size_t const entry_size = 8 + 8 + 8 + 4 + 4 + 4 + 4;
+
+template <typename UINT>
+UINT read_le(char const* p)
+{
+    UINT result = 0;
+    for (size_t i = 0; i < sizeof(UINT); ++i) {
+        result |= UINT(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return result;
+}
+
+template <typename UINT>
+void write_le(std::ostream& out, UINT value)
+{
+    char buf[sizeof(UINT)];
+    for (size_t i = 0; i < sizeof(UINT); ++i) {
+        buf[i] = char((value >> (8 * i)) & 0xFF);
+    }
+    out.write(buf, sizeof buf);
+}
+
+}  // end anonymous namespace
+
+char const* const Resource_pack::default_filename = "ge211.pack";
+
+Resource_pack::Resource_pack() NOEXCEPT
+{ }
+
+uint64_t Resource_pack::hash(char const* name, size_t length) NOEXCEPT
+{
+    // 64-bit FNV-1a, which is stable across platforms (unlike std::hash).
+    uint64_t result = 0xCBF29CE484222325u;
+    for (size_t i = 0; i < length; ++i) {
+        result ^= static_cast<unsigned char>(name[i]);
+        result *= 0x100000001B3u;
+    }
+    return result;
+}
+
+bool Resource_pack::load(std::istream& in)
+{
+    bytes_.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+    index_.clear();
+
+    auto fail = [this] {
+        bytes_.clear();
+        index_.clear();
+        return false;
+    };
+
+    if (bytes_.size() < header_size ||
+        !std::equal(pack_magic, pack_magic + sizeof pack_magic,
+                    bytes_.data()))
+        return fail();
+
+    char const* p = bytes_.data() + sizeof pack_magic;
+    if (read_le<uint32_t>(p) != pack_version) return fail();
+    uint64_t count = read_le<uint32_t>(p + 4);
+
+    if ((bytes_.size() - header_size) / entry_size < count) return fail();
+
+    index_.reserve(count);
+    p = bytes_.data() + header_size;
+
+    for (uint64_t i = 0; i < count; ++i, p += entry_size) {
+        Entry_ entry;
+        entry.hash        = read_le<uint64_t>(p);
+        entry.offset      = read_le<uint64_t>(p + 8);
+        entry.size        = read_le<uint64_t>(p + 16);
+        entry.name_offset = read_le<uint32_t>(p + 24);
+        entry.name_length = read_le<uint32_t>(p + 28);
+        uint32_t flags    = read_le<uint32_t>(p + 32);
+
+        if (flags != 0 ||
+            entry.offset > bytes_.size() ||
+            entry.size > bytes_.size() - entry.offset ||
+            uint64_t(entry.name_offset) + entry.name_length > bytes_.size())
+            return fail();
+
+        index_.push_back(entry);
+    }
+
+    auto by_hash = [](Entry_ const& a, Entry_ const& b) {
+        return a.hash < b.hash;
+    };
+    if (!std::is_sorted(index_.begin(), index_.end(), by_hash))
+        return fail();
+
+    return true;
+}
+
+bool Resource_pack::find(std::string const& name, Blob& out) const NOEXCEPT
+{
+    Entry_ key{hash(name.data(), name.size()), 0, 0, 0, 0};
+
+    auto range = std::equal_range(
+            index_.begin(), index_.end(), key,
+            [](Entry_ const& a, Entry_ const& b) { return a.hash < b.hash; });
+
+    for (auto i = range.first; i != range.second; ++i) {
+        if (name.compare(0, std::string::npos,
+                         bytes_.data() + i->name_offset,
+                         i->name_length) == 0) {
+            out.data = bytes_.data() + i->offset;
+            out.size = size_t(i->size);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Resource_pack::write(
+        std::ostream& out,
+        std::vector<std::pair<std::string, std::string>> files)
+{
+    std::sort(files.begin(), files.end(),
+              [](auto const& a, auto const& b) {
+                  return a.first < b.first;
+              });
+
+    auto dup = std::adjacent_find(
+            files.begin(), files.end(),
+            [](auto const& a, auto const& b) { return a.first == b.first; });
+    if (dup != files.end())
+        throw Client_logic_error("Resource_pack::write: duplicate name: "
+                                 + dup->first);
+
+    struct Pending
+    {
+        uint64_t hash;
+        std::string const* name;
+        std::string const* contents;
+    };
+
+    std::vector<Pending> entries;
+    entries.reserve(files.size());
+    for (auto const& file : files) {
+        entries.push_back({hash(file.first.data(), file.first.size()),
+                           &file.first, &file.second});
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](Pending const& a, Pending const& b) {
+                  return std::tie(a.hash, *a.name) <
+                         std::tie(b.hash, *b.name);
+              });
+
+    uint64_t names_start = header_size + entry_size * entries.size();
+    uint64_t names_size  = 0;
+    for (auto const& entry : entries) names_size += entry.name->size();
+
+    // The entry count and name offsets are 32 bits.
+    if (entries.size() > UINT32_MAX ||
+        names_start + names_size > UINT32_MAX)
+        throw Client_logic_error("Resource_pack::write: too many files "
+                                 "or names too long for a pack");
+
+    out.write(pack_magic, sizeof pack_magic);
+    write_le<uint32_t>(out, pack_version);
+    write_le<uint32_t>(out, uint32_t(entries.size()));
+
+    uint64_t name_offset = names_start;
+    uint64_t data_offset = names_start + names_size;
+
+    for (auto const& entry : entries) {
+        write_le<uint64_t>(out, entry.hash);
+        write_le<uint64_t>(out, data_offset);
+        write_le<uint64_t>(out, entry.contents->size());
+        write_le<uint32_t>(out, uint32_t(name_offset));
+        write_le<uint32_t>(out, uint32_t(entry.name->size()));
+        write_le<uint32_t>(out, 0);
+        write_le<uint32_t>(out, 0);
+
+        name_offset += entry.name->size();
+        data_offset += entry.contents->size();
+    }
+
+    for (auto const& entry : entries)
+        out.write(entry.name->data(), std::streamsize(entry.name->size()));
+
+    for (auto const& entry : entries)
+        out.write(entry.contents->data(),
+                  std::streamsize(entry.contents->size()));
+}
+
+} // end namespace detail
+
+}
@@ -0,0 +1,153 @@
+#include "ge211/particles.hxx"
+#include "ge211/error.hxx"
+#include "ge211/render.hxx"
+
+namespace ge211 {
+
+namespace sprites {
+
+Particle_system::Particle_system(size_t capacity, Dims<int> extent,
+                                 float particle_size)
+        : extent_{extent},
+          particle_size_{particle_size},
+          x_(capacity), y_(capacity),
+          dx_(capacity), dy_(capacity),
+          age_(capacity), lifetime_(capacity),
+          opacity_(capacity),
+          color_(capacity)
+{
+    if (extent.width <= 0 || extent.height <= 0)
+        throw Client_logic_error("Particle_system: extent must be positive");
+
+    if (!(particle_size > 0))
+        throw Client_logic_error(
+                "Particle_system: particle_size must be positive");
+}
+
+Dims<int> Particle_system::dimensions() const
+{
+    return extent_;
+}
+
+bool Particle_system::emit(Posn<float> position,
+                           Dims<float> velocity,
+                           Color color,
+                           double lifetime)
+{
+    if (size_ == capacity()) return false;
+
+    if (!(position.x >= 0 && position.x < extent_.width &&
+          position.y >= 0 && position.y < extent_.height))
+        return false;
+
+    size_t i = size_++;
+    x_[i]        = position.x;
+    y_[i]        = position.y;
+    dx_[i]       = velocity.width;
+    dy_[i]       = velocity.height;
+    age_[i]      = 0;
+    lifetime_[i] = float(lifetime);
+    opacity_[i]  = 1;
+    color_[i]    = color;
+    return true;
+}
+
+void Particle_system::update(double dt)
+{
+    age_and_fade_(float(dt));
+    integrate_(float(dt));
+    remove_dead_();
+}
+
+void Particle_system::clear() NOEXCEPT
+{
+    size_ = 0;
+}
+
+// The loops in integrate_ and age_and_fade_ have no branches or
+// dependencies between particles, so that the compiler can vectorize
+// them; we copy the data pointers into locals so it can see that the
+// arrays don't change size.
+
+void Particle_system::integrate_(float dt) NOEXCEPT
+{
+    float* x  = x_.data();
+    float* y  = y_.data();
+    float* dx = dx_.data();
+    float* dy = dy_.data();
+    float ddx = gravity_.width * dt;
+    float ddy = gravity_.height * dt;
+    size_t n  = size_;
+
+    for (size_t i = 0; i < n; ++i) {
+        dx[i] += ddx;
+        dy[i] += ddy;
+        x[i]  += dx[i] * dt;
+        y[i]  += dy[i] * dt;
+    }
+}
+
+void Particle_system::age_and_fade_(float dt) NOEXCEPT
+{
+    float* age            = age_.data();
+    float const* lifetime = lifetime_.data();
+    float* opacity        = opacity_.data();
+    size_t n              = size_;
+
+    for (size_t i = 0; i < n; ++i)
+        age[i] += dt;
+
+    if (!fade_) return;
+
+    for (size_t i = 0; i < n; ++i) {
+        float remaining = 1 - age[i] / lifetime[i];
+        opacity[i] = remaining > 0 ? remaining : 0;
+    }
+}
+
+// Removes each dead particle by moving the last live particle into its
+// place, which is why particles are not kept in any particular order.
+void Particle_system::remove_dead_() NOEXCEPT
+{
+    float width  = float(extent_.width);
+    float height = float(extent_.height);
+
+    size_t i = 0;
+    while (i < size_) {
+        bool alive = age_[i] < lifetime_[i] &&
+                     x_[i] >= 0 && x_[i] < width &&
+                     y_[i] >= 0 && y_[i] < height;
+
+        if (alive) {
+            ++i;
+            continue;
+        }
+
+        size_t last = --size_;
+        x_[i]        = x_[last];
+        y_[i]        = y_[last];
+        dx_[i]       = dx_[last];
+        dy_[i]       = dy_[last];
+        age_[i]      = age_[last];
+        lifetime_[i] = lifetime_[last];
+        opacity_[i]  = opacity_[last];
+        color_[i]    = color_[last];
+    }
+}
+
+void Particle_system::render(detail::Renderer& renderer,
+                             Posn<int> position,
+                             Transform const& transform) const
+{
+    Dims<float> scale{float(transform.get_scale_x()),
+                      float(transform.get_scale_y())};
+
+    renderer.fill_squares(x_.data(), y_.data(),
+                          color_.data(), opacity_.data(),
+                          size_, particle_size_,
+                          position.into<float>(), scale);
+}
+
+} // end namespace sprites
+
+}
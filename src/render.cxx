@@ -4,6 +4,7 @@
 
 #include <SDL.h>
 
+#include <cmath>
 #include <utility>
 
 static inline SDL_RendererFlip&
@@ -152,6 +153,206 @@ void Renderer::copy(const Texture& texture,
     }
 }
 
+void Renderer::copy(const Texture& texture,
+                    Posn<float> xy,
+                    const Transform& transform)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+    auto raw_texture = texture.get_raw_(*this);
+    if (!raw_texture) return;
+
+    auto dims = texture.dimensions();
+
+    SDL_FRect dstrect;
+    dstrect.x = xy.x;
+    dstrect.y = xy.y;
+    dstrect.w = float(dims.width * transform.get_scale_x());
+    dstrect.h = float(dims.height * transform.get_scale_y());
+
+    SDL_RendererFlip flip = SDL_FLIP_NONE;
+    if (transform.get_flip_h()) flip |= SDL_FLIP_HORIZONTAL;
+    if (transform.get_flip_v()) flip |= SDL_FLIP_VERTICAL;
+
+    int render_result = SDL_RenderCopyExF(
+            get_raw_(), raw_texture,
+            nullptr, &dstrect,
+            transform.get_rotation(), nullptr,
+            flip);
+
+    if (render_result < 0) {
+        warn_sdl() << "Could not render texture";
+    }
+#else
+    // Before SDL 2.0.10, positions are whole pixels.
+    copy(texture,
+         {int(std::lround(xy.x)), int(std::lround(xy.y))},
+         transform);
+#endif
+}
+
+void Renderer::fill_squares(const float* xs, const float* ys,
+                            const Color* colors, const float* opacities,
+                            size_t count, float size,
+                            Posn<float> offset, Dims<float> scale)
+{
+    if (count == 0) return;
+
+    auto raw = get_raw_();
+    float width  = size * scale.width;
+    float height = size * scale.height;
+
+    auto alpha = [=](size_t i) {
+        return Uint8(colors[i].alpha() * opacities[i] + 0.5f);
+    };
+
+    SDL_BlendMode old_mode;
+    SDL_GetRenderDrawBlendMode(raw, &old_mode);
+    SDL_SetRenderDrawBlendMode(raw, SDL_BLENDMODE_BLEND);
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    // Two triangles per square. The indices never change, so we only
+    // ever add to them.
+    while (indices_.size() < 6 * count) {
+        int first = int(indices_.size() / 6 * 4);
+        for (int corner : {0, 1, 2, 2, 1, 3})
+            indices_.push_back(first + corner);
+    }
+
+    vertices_.resize(4 * count);
+
+    for (size_t i = 0; i < count; ++i) {
+        float x0 = offset.x + xs[i] * scale.width;
+        float y0 = offset.y + ys[i] * scale.height;
+        float x1 = x0 + width;
+        float y1 = y0 + height;
+
+        SDL_Color color{colors[i].red(), colors[i].green(),
+                        colors[i].blue(), alpha(i)};
+
+        SDL_Vertex* v = &vertices_[4 * i];
+        v[0] = {{x0, y0}, color, {0, 0}};
+        v[1] = {{x1, y0}, color, {0, 0}};
+        v[2] = {{x0, y1}, color, {0, 0}};
+        v[3] = {{x1, y1}, color, {0, 0}};
+    }
+
+    if (SDL_RenderGeometry(raw, nullptr,
+                           vertices_.data(), int(4 * count),
+                           indices_.data(), int(6 * count)) < 0) {
+        warn_sdl() << "Could not render squares";
+    }
+#else
+    // Before SDL 2.0.18, each square is its own draw call.
+    for (size_t i = 0; i < count; ++i) {
+        SDL_Rect rect;
+        rect.x = int(std::lround(offset.x + xs[i] * scale.width));
+        rect.y = int(std::lround(offset.y + ys[i] * scale.height));
+        rect.w = int(std::lround(width));
+        rect.h = int(std::lround(height));
+
+        SDL_SetRenderDrawColor(raw, colors[i].red(), colors[i].green(),
+                               colors[i].blue(), alpha(i));
+        SDL_RenderFillRect(raw, &rect);
+    }
+#endif
+
+    SDL_SetRenderDrawBlendMode(raw, old_mode);
+}
+
+void Renderer::copy(const Texture& texture,
+                    const Rect<int>& source,
+                    Posn<int> xy)
+{
+    auto raw_texture = texture.get_raw_(*this);
+    if (!raw_texture) return;
+
+    SDL_Rect srcrect = source;
+    SDL_Rect dstrect = Rect<int>::from_top_left(xy, source.dimensions());
+
+    if (SDL_RenderCopy(get_raw_(), raw_texture, &srcrect, &dstrect) < 0) {
+        warn_sdl() << "Could not render texture";
+    }
+}
+
+Dims<int> Renderer::output_dimensions() const
+{
+    Dims<int> result{0, 0};
+
+    if (SDL_Texture* target = SDL_GetRenderTarget(get_raw_()))
+        SDL_QueryTexture(target, nullptr, nullptr,
+                         &result.width, &result.height);
+    else
+        SDL_GetRendererOutputSize(get_raw_(), &result.width, &result.height);
+
+    return result;
+}
+
+Texture Renderer::create_target(Dims<int> dims)
+{
+    if (!SDL_RenderTargetSupported(get_raw_()))
+        throw Host_error{"Renderer cannot render to textures"};
+
+    Uniq_SDL_Texture raw(SDL_CreateTexture(get_raw_(),
+                                           SDL_PIXELFORMAT_ARGB8888,
+                                           SDL_TEXTUREACCESS_TARGET,
+                                           dims.width, dims.height));
+    if (!raw)
+        throw Host_error{"Could not create render target"};
+
+    premultiplied_targets_ = false;
+
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+    SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+            SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+            SDL_BLENDOPERATION_ADD);
+
+    // Not every renderer supports custom blend modes.
+    premultiplied_targets_ =
+            SDL_SetTextureBlendMode(raw.get(), premultiplied) == 0;
+#endif
+
+    if (!premultiplied_targets_)
+        SDL_SetTextureBlendMode(raw.get(), SDL_BLENDMODE_BLEND);
+
+    Texture result;
+    result.impl_ = std::make_shared<Texture::Impl_>(std::move(raw));
+    return result;
+}
+
+void Renderer::clear_target(Color color)
+{
+    if (premultiplied_targets_) {
+        auto times_alpha = [=](uint8_t component) {
+            return uint8_t((component * color.alpha() + 127) / 255);
+        };
+
+        color = Color(times_alpha(color.red()),
+                      times_alpha(color.green()),
+                      times_alpha(color.blue()),
+                      color.alpha());
+    }
+
+    set_color(color);
+    clear();
+}
+
+Renderer::Target_scope::Target_scope(Renderer& renderer,
+                                     const Texture& target)
+        : renderer_(renderer),
+          previous_(SDL_GetRenderTarget(renderer.get_raw_()))
+{
+    if (SDL_SetRenderTarget(renderer_.get_raw_(), target.get_raw_(renderer_)))
+        throw Host_error{"Could not set render target"};
+}
+
+Renderer::Target_scope::~Target_scope()
+{
+    if (SDL_SetRenderTarget(renderer_.get_raw_(), previous_))
+        warn_sdl() << "Could not restore render target";
+}
+
 void Renderer::prepare(const Texture& texture) const
 {
     texture.get_raw_(*this);
@@ -225,6 +426,19 @@ bool Texture::empty() const NOEXCEPT
     return impl_ == nullptr;
 }
 
+bool Texture::is_shared() const NOEXCEPT
+{
+    return impl_.use_count() > 1;
+}
+
+void Texture::replace(Uniq_SDL_Surface surface)
+{
+    if (impl_)
+        *impl_ = Impl_(std::move(surface));
+    else
+        impl_ = std::make_shared<Impl_>(std::move(surface));
+}
+
 } // end namespace detail
 
 }
@@ -1,12 +1,27 @@
 #include "ge211/resource.hxx"
 #include "ge211/error.hxx"
+#include "ge211/hot_reload.hxx"
+#include "ge211/pack.hxx"
 #include "ge211/session.hxx"
 
 #include <SDL.h>
 #include <SDL_ttf.h>
 
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <dirent.h>
+#endif
+
+#include <sys/stat.h>
+
+#include <algorithm>
 #include <ios>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace ge211 {
 
@@ -20,26 +35,164 @@ static const char* search_prefixes[] = {
         GE211_RESOURCES
 };
 
+static const int prefix_count =
+        int(sizeof search_prefixes / sizeof *search_prefixes);
+
+// Remembers, for each filename we have found, the index of the prefix
+// where we found it. This way repeated loads of the same resource go
+// straight to the right directory instead of probing the filesystem
+// once per prefix. Misses aren't remembered, since the file may be
+// created later (or the lookup may have failed for a passing reason,
+// such as running out of file descriptors).
+class Resolution_cache
+{
+public:
+    static const int unknown = -1;
+
+    int lookup(std::string const& filename) const
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto iter = map_.find(filename);
+        return iter == map_.end() ? unknown : iter->second;
+    }
+
+    void store(std::string const& filename, int prefix_index)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        map_[filename] = prefix_index;
+    }
+
+    void store_all(std::unordered_map<std::string, int> const& entries)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (auto const& entry : entries) {
+            map_[entry.first] = entry.second;
+        }
+    }
+
+    static Resolution_cache& instance()
+    {
+        static Resolution_cache instance;
+        return instance;
+    }
+
+private:
+    Resolution_cache() = default;
+
+    mutable std::mutex lock_;
+    std::unordered_map<std::string, int> map_;
+};
+
 template <class OPENER>
 typename OPENER::result_t
 open_resource_(std::string const& filename)
 {
+    auto& cache = Resolution_cache::instance();
+    int cached = cache.lookup(filename);
+
     std::string path;
 
-    for (auto prefix : search_prefixes) {
-        path.clear();
-        path += prefix;
+    if (cached >= 0) {
+        path += search_prefixes[cached];
         path += filename;
 
         auto result = OPENER::open(path);
         if (result) return result;
+
+        // The file moved or went away, so search from scratch.
+    }
+
+    for (int i = 0; i < prefix_count; ++i) {
+        path.clear();
+        path += search_prefixes[i];
+        path += filename;
+
+        auto result = OPENER::open(path);
+        if (result) {
+            cache.store(filename, i);
+            return result;
+        }
     }
 
     return OPENER::fail(filename);
 }
 
+// Calls `visit(relative_path)` for each regular file in directory
+// `root`, recursively. Symbolic links to directories aren't followed,
+// since they could form a loop.
+template <class VISITOR>
+void for_each_file_(std::string const& root,
+                    std::string const& relative,
+                    VISITOR& visit)
+{
+    std::string dir = root + relative;
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((dir + "*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE) return;
+
+    do {
+        std::string name = data.cFileName;
+        if (name == "." || name == "..") continue;
+
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            if (!(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+                for_each_file_(root, relative + name + "/", visit);
+        } else {
+            visit(relative + name);
+        }
+    } while (FindNextFileA(handle, &data));
+
+    FindClose(handle);
+#else
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) return;
+
+    while (dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+
+        std::string path = dir + name;
+
+        struct stat info;
+        if (lstat(path.c_str(), &info) != 0) continue;
+
+        // A link to a regular file counts as the file.
+        if (S_ISLNK(info.st_mode) &&
+            (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)))
+            continue;
+
+        if (S_ISDIR(info.st_mode))
+            for_each_file_(root, relative + name + "/", visit);
+        else if (S_ISREG(info.st_mode))
+            visit(relative + name);
+    }
+
+    closedir(handle);
+#endif
+}
+
 }  // end anonymous namespace
 
+void scan_resource_directories()
+{
+    std::unordered_map<std::string, int> found;
+
+    for (int i = 0; i < prefix_count; ++i) {
+        // emplace keeps the first (highest-priority) prefix for each file.
+        auto visit = [&](std::string const& filename) {
+            found.emplace(filename, i);
+        };
+        for_each_file_(search_prefixes[i], "", visit);
+    }
+
+    Resolution_cache::instance().store_all(found);
+
+    internal::logging::debug()
+            << "Resource scan found " << found.size() << " files";
+}
+
 namespace detail {
 
 template <bool BinaryMode>
@@ -79,9 +232,55 @@ open_binary_resource_file(std::string const& filename)
 
 namespace detail {
 
+static Resource_pack
+load_pack_()
+{
+    struct Opener
+    {
+        using result_t = std::ifstream;
+
+        static result_t open(std::string const& path)
+        {
+            return result_t(path, ifstream_opener<true>::mode);
+        }
+
+        static result_t fail(std::string const&)
+        {
+            return result_t();
+        }
+    };
+
+    Resource_pack result;
+
+    auto in = open_resource_<Opener>(Resource_pack::default_filename);
+    if (!in) return result;
+
+    if (result.load(in)) {
+        internal::logging::info()
+                << "Loaded " << result.size() << " resources from "
+                << Resource_pack::default_filename;
+    } else {
+        internal::logging::warn()
+                << "Ignoring malformed resource pack: "
+                << Resource_pack::default_filename;
+    }
+
+    return result;
+}
+
+Resource_pack const& File_resource::pack()
+{
+    static Resource_pack const instance = load_pack_();
+    return instance;
+}
+
 static SDL_RWops*
 open_rwops_(const std::string& filename)
 {
+    Resource_pack::Blob blob;
+    if (File_resource::pack().find(filename, blob))
+        return SDL_RWFromConstMem(blob.data, int(blob.size));
+
     struct Opener
     {
         using result_t = SDL_RWops*;
@@ -107,6 +306,43 @@ File_resource::File_resource(const std::string& filename)
         throw File_open_error(filename);
 }
 
+Resource_location File_resource::locate(const std::string& filename)
+{
+    Resource_pack::Blob blob;
+    if (pack().find(filename, blob))
+        return {"pack:" + filename, 0};
+
+    struct Locator
+    {
+        struct result_t
+        {
+            Resource_location location;
+            explicit operator bool() const
+            { return !location.path.empty(); }
+        };
+
+        static result_t open(std::string const& path)
+        {
+            struct stat info;
+            if (stat(path.c_str(), &info) != 0) return {};
+            return {{path, (long long) info.st_mtime}};
+        }
+
+        static result_t fail(std::string const& filename)
+        {
+            throw File_open_error(filename);
+        }
+    };
+
+    return open_resource_<Locator>(filename).location;
+}
+
+std::vector<std::string> File_resource::search_directories()
+{
+    return std::vector<std::string>(search_prefixes,
+                                    search_prefixes + prefix_count);
+}
+
 void File_resource::close_rwops_(Owned<SDL_RWops> ptr)
 {
     SDL_RWclose(ptr);
@@ -119,14 +355,88 @@ static Owned<TTF_Font> open_ttf_(const std::string& filename, int size)
     return TTF_OpenFontRW(File_resource(filename).release(), 1, size);
 }
 
+namespace detail {
+
+// When hot reloading, remembers every Font loaded from each file, so
+// that they can all be reopened when the file changes.
+class Font_registry
+{
+public:
+    void insert(std::string const& path,
+                std::shared_ptr<Font::Impl_> const& impl)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto& fonts = map_[path];
+        fonts.erase(std::remove_if(fonts.begin(), fonts.end(),
+                                   [](std::weak_ptr<Font::Impl_> const& w) {
+                                       return w.expired();
+                                   }),
+                    fonts.end());
+        fonts.push_back(impl);
+    }
+
+    // Reopens every live Font loaded from `path`. Must be called on the
+    // main thread, since FreeType isn't thread-safe.
+    void reopen(std::string const& path)
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto iter = map_.find(path);
+        if (iter == map_.end()) return;
+
+        for (auto const& weak : iter->second) {
+            auto impl = weak.lock();
+            if (!impl) continue;
+
+            TTF_Font* raw = TTF_OpenFontRW(SDL_RWFromFile(path.c_str(), "rb"),
+                                           1, impl->size);
+            if (raw) {
+                impl->ptr = raw;
+            } else {
+                internal::logging::warn()
+                        << "Hot reload: could not reload font " << path;
+            }
+        }
+    }
+
+    static Font_registry& instance()
+    {
+        static Font_registry instance;
+        return instance;
+    }
+
+private:
+    Font_registry() = default;
+
+    std::mutex lock_;
+    std::unordered_map<std::string,
+                       std::vector<std::weak_ptr<Font::Impl_>>> map_;
+};
+
+Resource_watcher::Action reload_font(std::string const& path)
+{
+    // Text that has already been rendered keeps its old appearance.
+    return [path] { Font_registry::instance().reopen(path); };
+}
+
+} // end namespace detail
+
 Font::Font(const std::string& filename, int size)
-        : ptr_(open_ttf_(filename, size))
+        : impl_(std::make_shared<Impl_>())
 {
     Session::check_session("Font loading");
 
-    if (!ptr_) {
+    impl_->ptr = open_ttf_(filename, size);
+    impl_->size = size;
+
+    if (!impl_->ptr) {
         throw Font_load_error{filename};
     }
+
+    if (Resource_watcher::is_requested()) {
+        auto path = File_resource::locate(filename).path;
+        Font_registry::instance().insert(path, impl_);
+        Resource_watcher::track(path, Resource_watcher::Kind::font);
+    }
 }
 
 }
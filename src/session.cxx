@@ -1,5 +1,7 @@
 #include "ge211/session.hxx"
 #include "ge211/error.hxx"
+#include "ge211/resource.hxx"
+#include "ge211/sprites.hxx"
 #include "ge211/util.hxx"
 
 #include <SDL.h>
@@ -20,6 +22,11 @@ Sdl_session::Sdl_session()
         fatal_sdl() << "Could not initialize SDL2";
         exit(1);
     }
+
+    // Games can run without controllers, so this isn't fatal; the
+    // engine checks SDL_WasInit before polling them.
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0)
+        warn_sdl() << "Could not initialize game controller support";
 }
 
 Sdl_session::~Sdl_session()
@@ -68,11 +75,17 @@ Session::Session()
 {
     setlocale(LC_ALL, "en_US.utf8");
     ++session_count_;
+
+    // Load the resource pack, if any, up front rather than on the
+    // first resource access.
+    File_resource::pack();
 }
 
 Session::~Session()
 {
-    --session_count_;
+    // Cached images must be freed while SDL is still running.
+    if (--session_count_ == 0)
+        Image_sprite::clear_image_cache();
 }
 
 std::atomic<int> Session::session_count_{0};
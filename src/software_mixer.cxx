@@ -0,0 +1,384 @@
+#include "ge211/software_mixer.hxx"
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ge211 {
+
+namespace detail {
+
+void set_voice_pan(Voice_state& voice, float pan) NOEXCEPT
+{
+    // Scaled so that a centered voice is at unity gain in both channels.
+    float const pi = 3.14159265f;
+    float angle = (std::max(-1.f, std::min(1.f, pan)) + 1) * pi / 4;
+    voice.left  = std::sqrt(2.f) * std::cos(angle);
+    voice.right = std::sqrt(2.f) * std::sin(angle);
+}
+
+namespace {
+
+// Mixes `count` frames of `voice`, starting from its current position,
+// with the gain starting at voice.gain and changing by `dg` per frame.
+// The caller guarantees that the run doesn't go past the last frame.
+//
+// The loops are written without branches or dependencies between
+// iterations so that the compiler can vectorize them.
+void mix_run(Voice_state const& voice, float* acc,
+             size_t count, int channels, float dg) NOEXCEPT
+{
+    int16_t const* samples = voice.samples;
+    float g0 = voice.gain;
+    float gl = channels == 2 ? voice.left : 1;
+    float gr = voice.right;
+
+    if (voice.step == 1 && voice.position == std::floor(voice.position)) {
+        int16_t const* src = samples + size_t(voice.position) * channels;
+
+        if (channels == 1) {
+            for (size_t i = 0; i < count; ++i)
+                acc[i] += src[i] * (g0 + dg * float(i));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                float g = g0 + dg * float(i);
+                acc[2 * i]     += src[2 * i] * (g * gl);
+                acc[2 * i + 1] += src[2 * i + 1] * (g * gr);
+            }
+        }
+
+        return;
+    }
+
+    // Resampling, by linear interpolation between neighboring frames.
+    size_t last = voice.frames - 1;
+
+    for (size_t i = 0; i < count; ++i) {
+        double pos = voice.position + voice.step * double(i);
+        size_t j   = std::min(size_t(pos), last);
+        size_t k   = j == last ? (voice.loop ? 0 : last) : j + 1;
+        float t    = float(pos - double(j));
+        float g    = g0 + dg * float(i);
+
+        if (channels == 1) {
+            acc[i] += (samples[j] + (samples[k] - samples[j]) * t) * g;
+        } else {
+            int16_t const* a = samples + 2 * j;
+            int16_t const* b = samples + 2 * k;
+            acc[2 * i]     += (a[0] + (b[0] - a[0]) * t) * (g * gl);
+            acc[2 * i + 1] += (a[1] + (b[1] - a[1]) * t) * (g * gr);
+        }
+    }
+}
+
+}  // end anonymous namespace
+
+bool mix_voice(Voice_state& voice,
+               float* acc,
+               size_t frames,
+               int channels) NOEXCEPT
+{
+    if (voice.frames == 0) return false;
+
+    size_t done = 0;
+
+    while (done < frames) {
+        if (voice.position >= double(voice.frames)) {
+            if (!voice.loop) return false;
+            voice.position = std::fmod(voice.position, double(voice.frames));
+        }
+
+        // Each run stops at the end of the samples or of the gain ramp,
+        // whichever comes first.
+        size_t run = frames - done;
+
+        if (voice.ramp_frames > 0)
+            run = std::min(run, size_t(voice.ramp_frames));
+
+        double remaining = (double(voice.frames) - voice.position) / voice.step;
+        run = std::min(run, std::max(size_t(1), size_t(std::ceil(remaining))));
+
+        float dg = 0;
+        if (voice.ramp_frames > 0)
+            dg = (voice.target_gain - voice.gain) / float(voice.ramp_frames);
+
+        mix_run(voice, acc + done * channels, run, channels, dg);
+
+        voice.position += voice.step * double(run);
+        done += run;
+
+        if (voice.ramp_frames > 0) {
+            voice.ramp_frames -= long(run);
+            voice.gain = voice.ramp_frames > 0 ?
+                         voice.gain + dg * float(run) :
+                         voice.target_gain;
+        }
+    }
+
+    return voice.loop || voice.position < double(voice.frames);
+}
+
+void add_and_clip(float const* acc, int16_t* stream, size_t n) NOEXCEPT
+{
+    for (size_t i = 0; i < n; ++i) {
+        float sample = stream[i] + acc[i];
+        sample = std::max(-32768.f, std::min(32767.f, sample));
+        stream[i] = int16_t(sample + (sample < 0 ? -0.5f : 0.5f));
+    }
+}
+
+constexpr size_t Software_mixer::queue_capacity;
+constexpr size_t Software_mixer::block_frames;
+Software_mixer* Software_mixer::active_ = nullptr;
+
+Software_mixer::Software_mixer(int channels, int frequency, int max_voices)
+        : channels_(channels)
+        , frequency_(frequency)
+        , max_voices_(size_t(max_voices))
+{
+    voices_.reserve(max_voices_);
+    voice_ids_.reserve(max_voices_);
+    unreported_.reserve(max_voices_ + queue_capacity);
+    acc_.resize(block_frames * size_t(channels_));
+
+    active_ = this;
+    Mix_SetPostMix(&post_mix_, this);
+}
+
+Software_mixer::~Software_mixer()
+{
+    // This waits for the audio thread to leave post_mix_().
+    Mix_SetPostMix(nullptr, nullptr);
+    active_ = nullptr;
+
+    for (auto const& retired : retired_)
+        SDL_free(retired.second);
+}
+
+Software_mixer::Voice_id
+Software_mixer::play(std::shared_ptr<Mix_Chunk> chunk,
+                     float gain, float pan, float pitch, bool loop)
+{
+    if (live_.size() >= max_voices_) return 0;
+
+    Command_ command{};
+    command.kind          = Command_::Kind::start;
+    command.id            = next_id_;
+    command.state.samples = reinterpret_cast<int16_t const*>(chunk->abuf);
+    command.state.frames  = chunk->alen / (sizeof(int16_t) * channels_);
+    command.state.step    = pitch;
+    command.state.gain    = gain;
+    command.state.target_gain = gain;
+    command.state.loop    = loop;
+    set_voice_pan(command.state, pan);
+
+    push_(command);
+    live_.emplace(next_id_, std::move(chunk));
+
+    // Zero means no voice, so skip it on wrapping around.
+    if (++next_id_ == 0) next_id_ = 1;
+
+    return command.id;
+}
+
+void Software_mixer::set_gain(Voice_id id, float gain, long ramp_frames)
+{
+    send_({Command_::Kind::gain, id, gain, ramp_frames, {}});
+}
+
+void Software_mixer::set_pan(Voice_id id, float pan)
+{
+    send_({Command_::Kind::pan, id, pan, 0, {}});
+}
+
+void Software_mixer::set_pitch(Voice_id id, float pitch)
+{
+    send_({Command_::Kind::pitch, id, pitch, 0, {}});
+}
+
+void Software_mixer::stop(Voice_id id)
+{
+    send_({Command_::Kind::stop, id, 0, 0, {}});
+}
+
+void Software_mixer::send_(Command_ const& command)
+{
+    if (is_live(command.id)) push_(command);
+}
+
+void Software_mixer::push_(Command_ const& command)
+{
+    // The audio thread drains the queue every buffer, so it fills up
+    // only if the device has stalled. Only the audio thread may touch
+    // its voices, so then we hold on to the command and retry later,
+    // keeping commands in order.
+    flush_backlog_();
+
+    if (!backlog_.empty() || !commands_.try_push(command))
+        backlog_.push_back(command);
+}
+
+void Software_mixer::flush_backlog_()
+{
+    while (!backlog_.empty() && commands_.try_push(backlog_.front()))
+        backlog_.pop_front();
+}
+
+void Software_mixer::collect_finished()
+{
+    flush_backlog_();
+
+    Voice_id id;
+    while (finished_.try_pop(id))
+        live_.erase(id);
+
+    free_retired_();
+}
+
+void Software_mixer::stop_voices_using(uint8_t* samples, bool free_samples)
+{
+    if (!active_) {
+        if (free_samples) SDL_free(samples);
+        return;
+    }
+
+    auto& self = *active_;
+
+    for (auto const& entry : self.live_) {
+        if (entry.second->abuf == samples)
+            self.stop(entry.first);
+    }
+
+    if (free_samples) {
+        uint32_t fence = self.next_fence_++;
+        self.push_({Command_::Kind::fence, fence, 0, 0, {}});
+        self.retired_.emplace_back(fence, samples);
+    }
+}
+
+void Software_mixer::free_retired_()
+{
+    uint32_t done = fence_done_.load(std::memory_order_acquire);
+
+    // Fence numbers may wrap around, so compare by difference.
+    auto is_done = [=](std::pair<uint32_t, void*> const& retired) {
+        return int32_t(done - retired.first) >= 0;
+    };
+
+    auto keep = std::partition(retired_.begin(), retired_.end(),
+                               [&](std::pair<uint32_t, void*> const& r) {
+                                   return !is_done(r);
+                               });
+
+    for (auto iter = keep; iter != retired_.end(); ++iter)
+        SDL_free(iter->second);
+
+    retired_.erase(keep, retired_.end());
+}
+
+void Software_mixer::post_mix_(void* self, uint8_t* stream, int len)
+{
+    static_cast<Software_mixer*>(self)->mix_(
+            reinterpret_cast<int16_t*>(stream),
+            size_t(len) / sizeof(int16_t));
+}
+
+void Software_mixer::apply_commands_()
+{
+    Command_ command;
+
+    while (commands_.try_pop(command)) {
+        if (command.kind == Command_::Kind::fence) {
+            fence_done_.store(command.id, std::memory_order_release);
+            continue;
+        }
+
+        if (command.kind == Command_::Kind::start) {
+            if (voices_.size() < max_voices_) {
+                voices_.push_back(command.state);
+                voice_ids_.push_back(command.id);
+            } else {
+                unreported_.push_back(command.id);
+            }
+            continue;
+        }
+
+        auto iter = std::find(voice_ids_.begin(), voice_ids_.end(),
+                              command.id);
+        if (iter == voice_ids_.end()) continue;
+
+        size_t index = size_t(iter - voice_ids_.begin());
+        Voice_state& voice = voices_[index];
+
+        switch (command.kind) {
+        case Command_::Kind::gain:
+            voice.target_gain = command.value;
+            voice.ramp_frames = command.ramp_frames;
+            if (command.ramp_frames <= 0) voice.gain = command.value;
+            break;
+
+        case Command_::Kind::pan:
+            set_voice_pan(voice, command.value);
+            break;
+
+        case Command_::Kind::pitch:
+            voice.step = command.value;
+            break;
+
+        case Command_::Kind::stop:
+            remove_voice_(index);
+            break;
+
+        case Command_::Kind::start:
+        case Command_::Kind::fence:
+            break;
+        }
+    }
+}
+
+void Software_mixer::remove_voice_(size_t index)
+{
+    unreported_.push_back(voice_ids_[index]);
+
+    voices_[index]    = voices_.back();
+    voice_ids_[index] = voice_ids_.back();
+    voices_.pop_back();
+    voice_ids_.pop_back();
+}
+
+void Software_mixer::mix_(int16_t* stream, size_t samples)
+{
+    apply_commands_();
+
+    for (size_t offset = 0;
+         offset < samples && !voices_.empty();
+         offset += acc_.size())
+    {
+        size_t count = std::min(acc_.size(), samples - offset);
+        size_t frames = count / size_t(channels_);
+
+        std::fill(acc_.begin(), acc_.begin() + count, 0.f);
+
+        for (size_t i = 0; i < voices_.size(); ) {
+            if (mix_voice(voices_[i], acc_.data(), frames, channels_))
+                ++i;
+            else
+                remove_voice_(i);
+        }
+
+        add_and_clip(acc_.data(), stream + offset, count);
+    }
+
+    // Report finished voices, keeping any that don't fit for next time.
+    size_t reported = 0;
+    while (reported < unreported_.size() &&
+           finished_.try_push(unreported_[reported]))
+        ++reported;
+    unreported_.erase(unreported_.begin(), unreported_.begin() + reported);
+}
+
+} // end namespace detail
+
+}
@@ -1,11 +1,17 @@
 #include "ge211/sprites.hxx"
 #include "ge211/error.hxx"
+#include "ge211/hot_reload.hxx"
 
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 
+#include <sys/stat.h>
+
+#include <algorithm>
 #include <cmath>
+#include <string>
+#include <unordered_map>
 
 namespace ge211 {
 
@@ -18,25 +24,292 @@ Sprite_set&
 Sprite_set::add_sprite(const Sprite& sprite, Posn<int> xy, int z,
                        const Transform& t)
 {
-    sprites_.emplace_back(sprite, xy, z, t);
+    sprites_.add(sprite, Posn<double>(xy), z, t, false);
+    return *this;
+}
+
+Sprite_set&
+Sprite_set::add_sprites(const Sprite& sprite,
+                        const std::vector<Posn<int>>& positions,
+                        int z)
+{
+    sprites_.add_run(sprite, positions, z, nullptr, nullptr);
+    return *this;
+}
+
+Sprite_set&
+Sprite_set::add_sprites(const Sprite& sprite,
+                        const std::vector<Posn<int>>& positions,
+                        const std::vector<int>& zs)
+{
+    if (zs.size() != positions.size())
+        throw Client_logic_error(
+                "Sprite_set::add_sprites: zs and positions differ in length");
+
+    sprites_.add_run(sprite, positions, 0, zs.data(), nullptr);
+    return *this;
+}
+
+Sprite_set&
+Sprite_set::add_sprites(const Sprite& sprite,
+                        const std::vector<Posn<int>>& positions,
+                        const std::vector<int>& zs,
+                        const std::vector<Transform>& transforms)
+{
+    if (zs.size() != positions.size())
+        throw Client_logic_error(
+                "Sprite_set::add_sprites: zs and positions differ in length");
+
+    if (transforms.size() != positions.size())
+        throw Client_logic_error(
+                "Sprite_set::add_sprites: transforms and positions differ"
+                " in length");
+
+    sprites_.add_run(sprite, positions, 0, zs.data(), transforms.data());
     return *this;
 }
 
+Sprite_set&
+Sprite_set::add_world_sprite(const Sprite& sprite, Posn<double> xy, int z,
+                             const Transform& t)
+{
+    sprites_.add(sprite, xy, z, t, true);
+    return *this;
+}
+
+size_t Sprite_set::paint_(Renderer& renderer, Dims<int> screen, bool cull)
+{
+    sprites_.apply_camera(camera_, screen);
+    size_t drawn = sprites_.order(cull, screen);
+    sprites_.render(renderer);
+    sprites_.clear();
+    return drawn;
+}
+
+namespace sprites {
+
+void Sprite::render_subpixel(detail::Renderer& renderer,
+                             Posn<float> position,
+                             Transform const& transform) const
+{
+    render(renderer,
+           {int(std::lround(position.x)), int(std::lround(position.y))},
+           transform);
+}
+
+} // end namespace sprites
+
 namespace detail {
 
-Placed_sprite::Placed_sprite(const Sprite& sprite, Posn<int> xy,
-                             int z, const Transform& transform) NOEXCEPT
-        : sprite{&sprite}, xy{xy}, z{z}, transform{transform}
-{ }
+constexpr uint32_t Placed_sprites::identity_;
+
+void Placed_sprites::add(const Sprite& sprite, Posn<double> xy, int z,
+                         const Transform& transform, bool in_world)
+{
+    auto index = uint32_t(sprites_.size());
+
+    sprites_.push_back(&sprite);
+    positions_.push_back(xy);
+    zs_.push_back(z);
+
+    transform_indices_.push_back(transform.is_identity()
+                                 ? identity_
+                                 : store_transform_(index, transform));
+
+    if (in_world) in_world_.push_back(index);
+}
+
+void Placed_sprites::add_run(const Sprite& sprite,
+                             const std::vector<Posn<int>>& positions,
+                             int z, const int* zs,
+                             const Transform* transforms)
+{
+    size_t first = sprites_.size();
+    size_t count = positions.size();
+    size_t total = first + count;
+
+    // Reserving exactly `total` on every call would reallocate each
+    // time, making many small runs quadratic, so grow geometrically.
+    if (total > sprites_.capacity()) {
+        size_t capacity = std::max(total, 2 * sprites_.capacity());
+        sprites_.reserve(capacity);
+        positions_.reserve(capacity);
+        zs_.reserve(capacity);
+        transform_indices_.reserve(capacity);
+    }
+
+    sprites_.insert(sprites_.end(), count, &sprite);
+    for (Posn<int> xy : positions)
+        positions_.push_back(Posn<double>(xy));
+
+    if (zs)
+        zs_.insert(zs_.end(), zs, zs + count);
+    else
+        zs_.insert(zs_.end(), count, z);
+
+    if (!transforms) {
+        transform_indices_.insert(transform_indices_.end(), count, identity_);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        transform_indices_.push_back(transforms[i].is_identity()
+                                     ? identity_
+                                     : store_transform_(first + i,
+                                                        transforms[i]));
+    }
+}
+
+void Placed_sprites::apply_camera(Camera const& camera, Dims<int> window)
+{
+    if (camera.is_translation()) {
+        Posn<double> position = camera.get_position();
+        for (uint32_t i : in_world_) {
+            positions_[i].x -= position.x;
+            positions_[i].y -= position.y;
+        }
+        return;
+    }
+
+    double zoom = camera.get_zoom();
+    world_transforms_.clear();
+
+    for (uint32_t i : in_world_) {
+        Transform const& transform = mutable_transform_(i);
+        world_transforms_.push_back(transform_indices_[i]);
+
+        // SDL rotates a sprite about its center, so we map the center
+        // and then find the corner from there.
+        Dims<double> half = Dims<double>(sprites_[i]->dimensions()) / 2;
+        half.width  *= transform.get_scale_x();
+        half.height *= transform.get_scale_y();
+
+        Posn<double> center = camera.to_screen(positions_[i] + half, window);
+        positions_[i] = center - half * zoom;
+    }
+
+    compose_transforms(transforms_.data(),
+                       world_transforms_.data(), world_transforms_.size(),
+                       Transform::scale(zoom)
+                               .set_rotation(camera.get_rotation()));
+}
+
+size_t Placed_sprites::order(bool cull, Dims<int> screen)
+{
+    order_.clear();
+
+    if (cull) compute_bounds_();
+
+    for (size_t i = 0; i < sprites_.size(); ++i) {
+        if (cull) {
+            Rect<double> const& b = bounds_[i];
+            if (b.x >= screen.width || b.x + b.width <= 0 ||
+                b.y >= screen.height || b.y + b.height <= 0)
+                continue;
+        }
+
+        // Flipping the sign bit makes unsigned order match signed order.
+        uint64_t biased_z = uint32_t(zs_[i]) ^ 0x80000000u;
+        order_.push_back(biased_z << 32 | i);
+    }
+
+    // Games often add sprites in z order already, or all at one z.
+    if (!std::is_sorted(order_.begin(), order_.end()))
+        std::sort(order_.begin(), order_.end());
+
+    return order_.size();
+}
+
+void Placed_sprites::render(Renderer& dst) const
+{
+    for (uint64_t key : order_)
+        render_(uint32_t(key), dst);
+}
+
+void Placed_sprites::clear() NOEXCEPT
+{
+    sprites_.clear();
+    positions_.clear();
+    zs_.clear();
+    transform_indices_.clear();
+    transforms_.clear();
+    transform_owners_.clear();
+    in_world_.clear();
+    order_.clear();
+}
+
+Transform const& Placed_sprites::transform_(size_t i) const NOEXCEPT
+{
+    static Transform const identity;
+
+    uint32_t index = transform_indices_[i];
+    return index == identity_ ? identity : transforms_[index];
+}
+
+Transform& Placed_sprites::mutable_transform_(size_t i)
+{
+    uint32_t& index = transform_indices_[i];
+
+    if (index == identity_)
+        index = store_transform_(i, Transform());
+
+    return transforms_[index];
+}
+
+uint32_t Placed_sprites::store_transform_(size_t sprite,
+                                          Transform const& transform)
+{
+    auto index = uint32_t(transforms_.size());
+    transforms_.push_back(transform);
+    transform_owners_.push_back(uint32_t(sprite));
+    return index;
+}
 
-void Placed_sprite::render(Renderer& dst) const
+void Placed_sprites::compute_bounds_()
 {
-    sprite->render(dst, xy, transform);
+    size_t count = sprites_.size();
+
+    dims_.clear();
+    for (size_t i = 0; i < count; ++i)
+        dims_.push_back(sprites_[i]->dimensions());
+
+    bounds_.clear();
+    for (size_t i = 0; i < count; ++i)
+        bounds_.push_back({positions_[i].x, positions_[i].y,
+                           double(dims_[i].width), double(dims_[i].height)});
+
+    // The sprites with transforms are gathered into arrays, so that
+    // their bounds can be found in one batch.
+    size_t transformed = transforms_.size();
+    if (transformed == 0) return;
+
+    transformed_xys_.clear();
+    transformed_dims_.clear();
+
+    for (uint32_t owner : transform_owners_) {
+        transformed_xys_.push_back(positions_[owner]);
+        transformed_dims_.push_back(dims_[owner]);
+    }
+
+    transformed_bounds_.assign(transformed, Rect<double>{0, 0, 0, 0});
+
+    transformed_bounds(transformed_xys_.data(), transformed_dims_.data(),
+                       transforms_.data(), transformed_bounds_.data(),
+                       transformed);
+
+    for (size_t j = 0; j < transformed; ++j)
+        bounds_[transform_owners_[j]] = transformed_bounds_[j];
 }
 
-bool operator<(const Placed_sprite& s1, const Placed_sprite& s2) NOEXCEPT
+void Placed_sprites::render_(size_t i, Renderer& dst) const
 {
-    return s1.z > s2.z;
+    Posn<double> xy = positions_[i];
+    Posn<int> whole{int(xy.x), int(xy.y)};
+
+    if (whole.x == xy.x && whole.y == xy.y)
+        sprites_[i]->render(dst, whole, transform_(i));
+    else
+        sprites_[i]->render_subpixel(dst, xy.into<float>(), transform_(i));
 }
 
 Dims<int> Texture_sprite::dimensions() const
@@ -54,6 +327,13 @@ void Texture_sprite::render(Renderer& renderer,
         renderer.copy(get_texture_(), position, transform);
 }
 
+void Texture_sprite::render_subpixel(Renderer& renderer,
+                                     Posn<float> position,
+                                     const Transform& transform) const
+{
+    renderer.copy(get_texture_(), position, transform);
+}
+
 void Texture_sprite::prepare(const Renderer& renderer) const
 {
     renderer.prepare(get_texture_());
@@ -184,18 +464,123 @@ int Circle_sprite::radius_() const
     return dimensions().width >> 1;
 }
 
+namespace {
+
+// Maps each resolved image path to the most recently loaded Texture
+// for that file, along with the file's modification time at loading.
+class Image_cache
+{
+public:
+    // Finds a cached texture for the given location, provided the file
+    // hasn't changed since it was cached.
+    bool find(Resource_location const& location, Texture& out)
+    {
+        auto iter = map_.find(location.path);
+        if (iter == map_.end() || iter->second.mtime != location.mtime) {
+            ++misses_;
+            return false;
+        }
+
+        ++hits_;
+        out = iter->second.texture;
+        return true;
+    }
+
+    void insert(Resource_location const& location, Texture const& texture)
+    {
+        map_[location.path] = {location.mtime, texture};
+    }
+
+    // Swaps in a new image for the entry at `path`, if any, updating
+    // every Image_sprite that shares it.
+    void replace(std::string const& path, long long mtime,
+                 Uniq_SDL_Surface surface)
+    {
+        auto iter = map_.find(path);
+        if (iter == map_.end()) return;
+
+        iter->second.mtime = mtime;
+        iter->second.texture.replace(std::move(surface));
+    }
+
+    void evict_unused()
+    {
+        for (auto iter = map_.begin(); iter != map_.end(); ) {
+            if (iter->second.texture.is_shared())
+                ++iter;
+            else
+                iter = map_.erase(iter);
+        }
+    }
+
+    void clear()
+    {
+        map_.clear();
+    }
+
+    Image_sprite::Cache_stats stats() const
+    {
+        return {map_.size(), hits_, misses_};
+    }
+
+    static Image_cache& instance()
+    {
+        static Image_cache instance;
+        return instance;
+    }
+
+private:
+    struct Entry_
+    {
+        long long mtime;
+        Texture texture;
+    };
+
+    std::unordered_map<std::string, Entry_> map_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+}  // end anonymous namespace
+
 Texture
 Image_sprite::load_texture_(const std::string& filename)
 {
+    auto& cache = Image_cache::instance();
+    auto location = File_resource::locate(filename);
+
+    Texture result;
+    if (cache.find(location, result))
+        return result;
+
     File_resource file(filename);
     SDL_Surface* raw = IMG_Load_RW(file.get_raw(), 0);
     if (raw) {
-        return Texture(raw);
+        result = Texture(raw);
+        cache.insert(location, result);
+        Resource_watcher::track(location.path,
+                                Resource_watcher::Kind::image);
+        return result;
     }
 
     throw Image_load_error{filename};
 }
 
+Image_sprite::Cache_stats Image_sprite::cache_stats()
+{
+    return Image_cache::instance().stats();
+}
+
+void Image_sprite::evict_unused_images()
+{
+    Image_cache::instance().evict_unused();
+}
+
+void Image_sprite::clear_image_cache()
+{
+    Image_cache::instance().clear();
+}
+
 Image_sprite::Image_sprite(const std::string& filename)
         : texture_{load_texture_(filename)} {}
 
@@ -350,6 +735,103 @@ void Multiplexed_sprite::render(detail::Renderer& renderer,
     selection.render(renderer, position, transform);
 }
 
+void Multiplexed_sprite::render_subpixel(detail::Renderer& renderer,
+                                         Posn<float> position,
+                                         Transform const& transform) const
+{
+    const Sprite& selection = select_(timer_.elapsed_time());
+    selection.render_subpixel(renderer, position, transform);
+}
+
+Render_target_sprite::Render_target_sprite(Dims<int> dimensions,
+                                           Color background)
+        : dimensions_{dimensions},
+          background_{background}
+{
+    if (dimensions.width <= 0 || dimensions.height <= 0)
+        throw Client_logic_error(
+                "Render_target_sprite: dimensions must be positive");
+}
+
+Dims<int> Render_target_sprite::dimensions() const
+{
+    return dimensions_;
+}
+
+Sprite_set& Render_target_sprite::redraw()
+{
+    contents_.sprites_.clear();
+    dirty_ = true;
+    return contents_;
+}
+
+void Render_target_sprite::render(detail::Renderer& renderer,
+                                  Posn<int> position,
+                                  Transform const& transform) const
+{
+    update_(renderer);
+
+    if (transform.is_identity())
+        renderer.copy(texture_, position);
+    else
+        renderer.copy(texture_, position, transform);
+}
+
+void Render_target_sprite::render_subpixel(detail::Renderer& renderer,
+                                           Posn<float> position,
+                                           Transform const& transform) const
+{
+    update_(renderer);
+    renderer.copy(texture_, position, transform);
+}
+
+void Render_target_sprite::update_(detail::Renderer& renderer) const
+{
+    if (texture_.empty())
+        texture_ = renderer.create_target(dimensions_);
+
+    if (target_generation_ != renderer.target_generation()) {
+        target_generation_ = renderer.target_generation();
+        dirty_ = true;
+    }
+
+    if (!dirty_) return;
+
+    Renderer::Target_scope scope(renderer, texture_);
+    renderer.clear_target(background_);
+
+    // Painting uses up a Sprite_set, so we paint a copy, keeping the
+    // contents in case the renderer loses the texture.
+    Sprite_set painting = contents_;
+    painting.paint_(renderer, dimensions_, true);
+    dirty_ = false;
+}
+
 } // end namespace sprites
 
+namespace detail {
+
+Resource_watcher::Action reload_image(std::string const& path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return {};
+    long long mtime = info.st_mtime;
+
+    auto surface = std::make_shared<Uniq_SDL_Surface>(
+            IMG_Load_RW(SDL_RWFromFile(path.c_str(), "rb"), 1));
+
+    if (!*surface) {
+        internal::logging::warn()
+                << "Hot reload: could not decode image " << path;
+        return {};
+    }
+
+    return [=] {
+        sprites::Image_cache::instance()
+                .replace(path, mtime, std::move(*surface));
+    };
+}
+
+} // end namespace detail
+
 }
@@ -0,0 +1,257 @@
+#include "ge211/tile_map.hxx"
+#include "ge211/error.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace ge211 {
+
+namespace sprites {
+
+using namespace detail;
+
+constexpr Tile_map::Tile Tile_map::no_tile;
+constexpr int Tile_map::chunk_tiles;
+
+namespace {
+
+// When more chunks than this have textures, those not rendered in the
+// current frame give theirs up, so that scrolling across a large map
+// doesn't keep the whole map in video memory.
+size_t const max_baked_chunks = 64;
+
+int chunks_for(int cells)
+{
+    return (cells + Tile_map::chunk_tiles - 1) / Tile_map::chunk_tiles;
+}
+
+}  // end anonymous namespace
+
+Tile_map::Tile_map(Sprite const& tileset,
+                   Dims<int> tile_dims,
+                   Dims<int> map_dims)
+        : tileset_(tileset),
+          tile_dims_(tile_dims),
+          map_dims_(map_dims),
+          chunk_grid_{chunks_for(map_dims.width), chunks_for(map_dims.height)},
+          tileset_columns_(0),
+          tileset_rows_(0)
+{
+    if (tile_dims.width <= 0 || tile_dims.height <= 0)
+        throw Client_logic_error("Tile_map: tile dimensions must be positive");
+
+    if (map_dims.width <= 0 || map_dims.height <= 0)
+        throw Client_logic_error("Tile_map: map dimensions must be positive");
+
+    Dims<int> tileset_dims = tileset.dimensions();
+    tileset_columns_ = tileset_dims.width / tile_dims.width;
+    tileset_rows_    = tileset_dims.height / tile_dims.height;
+
+    if (tileset_columns_ == 0 || tileset_rows_ == 0)
+        throw Client_logic_error("Tile_map: tiles are larger than tileset");
+
+    tiles_.assign(size_t(map_dims.width) * size_t(map_dims.height), no_tile);
+    chunks_.resize(size_t(chunk_grid_.width) * size_t(chunk_grid_.height));
+}
+
+Dims<int> Tile_map::dimensions() const
+{
+    return {map_dims_.width * tile_dims_.width,
+            map_dims_.height * tile_dims_.height};
+}
+
+Tile_map::Tile Tile_map::get_tile(Posn<int> cell) const
+{
+    return tiles_[index_(cell, "Tile_map::get_tile")];
+}
+
+Tile_map& Tile_map::set_tile(Posn<int> cell, Tile tile)
+{
+    check_tile_(tile, "Tile_map::set_tile");
+
+    Tile& slot = tiles_[index_(cell, "Tile_map::set_tile")];
+    if (slot == tile) return *this;
+
+    slot = tile;
+    Posn<int> chunk{cell.x / chunk_tiles, cell.y / chunk_tiles};
+    chunks_[size_t(chunk.y) * chunk_grid_.width + chunk.x].dirty = true;
+    return *this;
+}
+
+Tile_map& Tile_map::fill(Tile tile)
+{
+    check_tile_(tile, "Tile_map::fill");
+
+    std::fill(tiles_.begin(), tiles_.end(), tile);
+    for (Chunk_& chunk : chunks_)
+        chunk.dirty = true;
+
+    return *this;
+}
+
+void Tile_map::render(Renderer& renderer,
+                      Posn<int> position,
+                      Transform const& transform) const
+{
+    render_chunks_(renderer, position.into<float>(), transform);
+}
+
+void Tile_map::render_subpixel(Renderer& renderer,
+                               Posn<float> position,
+                               Transform const& transform) const
+{
+    render_chunks_(renderer, position, transform);
+}
+
+void Tile_map::render_chunks_(Renderer& renderer,
+                              Posn<float> position,
+                              Transform const& transform) const
+{
+    Dims<float> scale{float(transform.get_scale_x()),
+                      float(transform.get_scale_y())};
+    if (!(scale.width > 0 && scale.height > 0)) return;
+
+    // Some renderers lose the contents of render targets when the
+    // device is reset, so everything must be painted again.
+    if (target_generation_ != renderer.target_generation()) {
+        target_generation_ = renderer.target_generation();
+        tileset_texture_   = Texture();
+
+        for (Chunk_& chunk : chunks_)
+            chunk.dirty = true;
+    }
+
+    // A Texture_sprite's texture can be sliced directly; anything else
+    // is first painted into a texture of its own.
+    if (tileset_texture_.empty()) {
+        auto texture_sprite = dynamic_cast<Texture_sprite const*>(&tileset_);
+
+        if (texture_sprite) {
+            tileset_texture_ = texture_sprite->get_texture_();
+        } else {
+            tileset_texture_ = renderer.create_target(tileset_.dimensions());
+            Renderer::Target_scope scope(renderer, tileset_texture_);
+            renderer.clear_target(Color(0, 0, 0, 0));
+            tileset_.render(renderer, {0, 0}, Transform());
+        }
+    }
+
+    ++render_count_;
+
+    Dims<float> chunk_dims{float(chunk_tiles * tile_dims_.width),
+                           float(chunk_tiles * tile_dims_.height)};
+    chunk_dims.width  *= scale.width;
+    chunk_dims.height *= scale.height;
+
+    // Only the chunks that overlap the render target are rendered.
+    Dims<int> output = renderer.output_dimensions();
+    int first_col = std::max(0, int(std::floor(-position.x /
+                                               chunk_dims.width)));
+    int first_row = std::max(0, int(std::floor(-position.y /
+                                               chunk_dims.height)));
+    int end_col = std::min(chunk_grid_.width,
+                           int(std::ceil((output.width - position.x) /
+                                         chunk_dims.width)));
+    int end_row = std::min(chunk_grid_.height,
+                           int(std::ceil((output.height - position.y) /
+                                         chunk_dims.height)));
+
+    bool whole = scale == Dims<float>(1, 1) &&
+                 position.x == std::floor(position.x) &&
+                 position.y == std::floor(position.y);
+
+    Transform scaled;
+    scaled.set_scale_x(scale.width).set_scale_y(scale.height);
+
+    for (int row = first_row; row < end_row; ++row) {
+        for (int col = first_col; col < end_col; ++col) {
+            Chunk_& chunk = chunks_[size_t(row) * chunk_grid_.width + col];
+
+            if (chunk.dirty) bake_(renderer, chunk, {col, row});
+            chunk.last_rendered = render_count_;
+
+            Posn<float> xy{position.x + col * chunk_dims.width,
+                           position.y + row * chunk_dims.height};
+
+            if (whole)
+                renderer.copy(chunk.texture, xy.into<int>());
+            else
+                renderer.copy(chunk.texture, xy, scaled);
+        }
+    }
+
+    if (baked_chunks_ > max_baked_chunks) evict_unused_chunks_();
+}
+
+void Tile_map::bake_(Renderer& renderer,
+                     Chunk_& chunk,
+                     Posn<int> chunk_posn) const
+{
+    Posn<int> first{chunk_posn.x * chunk_tiles, chunk_posn.y * chunk_tiles};
+    Dims<int> cells{std::min(chunk_tiles, map_dims_.width - first.x),
+                    std::min(chunk_tiles, map_dims_.height - first.y)};
+
+    if (chunk.texture.empty()) {
+        chunk.texture = renderer.create_target(
+                {cells.width * tile_dims_.width,
+                 cells.height * tile_dims_.height});
+        ++baked_chunks_;
+    }
+
+    // Tiles are drawn with ordinary blending into a transparent chunk,
+    // which leaves the chunk premultiplied, as render targets expect.
+    Renderer::Target_scope scope(renderer, chunk.texture);
+    renderer.clear_target(Color(0, 0, 0, 0));
+
+    for (int y = 0; y < cells.height; ++y) {
+        Tile const* row = &tiles_[size_t(first.y + y) * map_dims_.width +
+                                  first.x];
+
+        for (int x = 0; x < cells.width; ++x) {
+            Tile tile = row[x];
+            if (tile == no_tile) continue;
+
+            Rect<int> source{tile % tileset_columns_ * tile_dims_.width,
+                             tile / tileset_columns_ * tile_dims_.height,
+                             tile_dims_.width,
+                             tile_dims_.height};
+
+            renderer.copy(tileset_texture_, source,
+                          {x * tile_dims_.width, y * tile_dims_.height});
+        }
+    }
+
+    chunk.dirty = false;
+}
+
+void Tile_map::evict_unused_chunks_() const
+{
+    for (Chunk_& chunk : chunks_) {
+        if (chunk.texture.empty() || chunk.last_rendered == render_count_)
+            continue;
+
+        chunk.texture = Texture();
+        chunk.dirty   = true;
+        --baked_chunks_;
+    }
+}
+
+void Tile_map::check_tile_(Tile tile, char const* who) const
+{
+    if (tile != no_tile && (tile < 0 || tile >= tile_count()))
+        throw Client_logic_error(std::string(who) + ": tile out of range");
+}
+
+size_t Tile_map::index_(Posn<int> cell, char const* who) const
+{
+    if (cell.x < 0 || cell.x >= map_dims_.width ||
+        cell.y < 0 || cell.y >= map_dims_.height)
+        throw Client_logic_error(std::string(who) + ": cell out of range");
+
+    return size_t(cell.y) * map_dims_.width + cell.x;
+}
+
+} // end namespace sprites
+
+}
@@ -0,0 +1,134 @@
+#include "doctest.hxx"
+
+#include <ge211/controller.hxx>
+
+#include <SDL.h>
+
+#include <cmath>
+
+using namespace ge211;
+using ge211::detail::Controller_tracker;
+
+TEST_SUITE_BEGIN("controller");
+
+TEST_CASE("stick deadzone is radial and rescaled")
+{
+    using detail::apply_stick_deadzone;
+
+    CHECK(apply_stick_deadzone({0.2f, 0.1f}, 0.25f) == Dims<float>(0, 0));
+
+    Dims<float> full = apply_stick_deadzone({1, 0}, 0.25f);
+    CHECK(full.width == doctest::Approx(1));
+    CHECK(full.height == doctest::Approx(0));
+
+    // Halfway between the deadzone and the edge, along a diagonal.
+    float d = 0.625f / std::sqrt(2.f);
+    Dims<float> half = apply_stick_deadzone({d, d}, 0.25f);
+    CHECK(half.width == doctest::Approx(0.5f / std::sqrt(2.f)));
+    CHECK(half.height == doctest::Approx(half.width));
+
+    // Corners of the square range are clamped to the unit circle.
+    Dims<float> corner = apply_stick_deadzone({1, 1}, 0.25f);
+    CHECK(corner.width == doctest::Approx(1 / std::sqrt(2.f)));
+}
+
+TEST_CASE("trigger deadzone")
+{
+    using detail::apply_trigger_deadzone;
+
+    CHECK(apply_trigger_deadzone(0.05f, 0.1f) == 0);
+    CHECK(apply_trigger_deadzone(0.55f, 0.1f) == doctest::Approx(0.5f));
+    CHECK(apply_trigger_deadzone(1, 0.1f) == doctest::Approx(1));
+}
+
+TEST_CASE("button edges and axes from raw values")
+{
+    Controller_tracker tracker;
+    auto const& state = tracker.state(0);
+
+    Controller_tracker::Buttons buttons;
+    Controller_tracker::Axes axes{};
+
+    buttons[size_t(Controller_button::a)] = true;
+    axes[size_t(Controller_axis::left_x)] = -32768;
+    axes[size_t(Controller_axis::right_trigger)] = 1000;
+    tracker.update(0, buttons, axes);
+
+    CHECK(state.is_down(Controller_button::a));
+    CHECK(state.was_pressed(Controller_button::a));
+    CHECK_FALSE(state.is_down(Controller_button::b));
+    CHECK(state.left_stick().width == doctest::Approx(-1));
+    CHECK(state.axis(Controller_axis::right_trigger) == 0);
+
+    buttons[size_t(Controller_button::b)] = true;
+    tracker.update(0, buttons, axes);
+
+    CHECK(state.is_down(Controller_button::a));
+    CHECK_FALSE(state.was_pressed(Controller_button::a));
+    CHECK(state.was_pressed(Controller_button::b));
+
+    tracker.update(0, {}, axes);
+
+    CHECK(state.was_released(Controller_button::a));
+    CHECK(state.was_released(Controller_button::b));
+    CHECK_FALSE(state.is_down(Controller_button::a));
+}
+
+TEST_CASE("out of range controllers are disconnected")
+{
+    Controller_tracker tracker;
+    CHECK_FALSE(tracker.state(0).is_connected());
+    CHECK_FALSE(tracker.state(Controller_tracker::max_controllers)
+                       .is_connected());
+    CHECK_FALSE(tracker.rumble(0, 1, 1, Duration(0.1)));
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+
+// Drives a controller through SDL's virtual joystick driver, which
+// needs no hardware or display.
+TEST_CASE("virtual controller")
+{
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0) {
+        MESSAGE("Could not initialize game controllers: " << SDL_GetError());
+        return;
+    }
+
+    int device = SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER,
+                                           SDL_CONTROLLER_AXIS_MAX,
+                                           SDL_CONTROLLER_BUTTON_MAX, 0);
+    REQUIRE(device >= 0);
+
+    SDL_Joystick* joystick = SDL_JoystickOpen(device);
+    REQUIRE(joystick);
+
+    {
+        Controller_tracker tracker;
+        auto const& state = tracker.state(0);
+
+        tracker.device_added(device);
+        tracker.device_added(device);
+        CHECK(state.is_connected());
+        CHECK_FALSE(tracker.state(1).is_connected());
+
+        SDL_JoystickSetVirtualButton(joystick, SDL_CONTROLLER_BUTTON_START, 1);
+        SDL_JoystickSetVirtualAxis(joystick, SDL_CONTROLLER_AXIS_LEFTY, 32767);
+        tracker.update();
+
+        CHECK(state.was_pressed(Controller_button::start));
+        CHECK(state.left_stick().height == doctest::Approx(1));
+
+        tracker.device_removed(SDL_JoystickInstanceID(joystick));
+        tracker.update();
+
+        CHECK_FALSE(state.is_connected());
+        CHECK(state.was_released(Controller_button::start));
+        CHECK(state.left_stick().height == 0);
+    }
+
+    SDL_JoystickClose(joystick);
+    SDL_JoystickDetachVirtual(device);
+    SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+}
+
+#endif // SDL_VERSION_ATLEAST(2, 0, 14)
@@ -0,0 +1,165 @@
+#include "doctest.hxx"
+
+#include <ge211/effect_cache.hxx>
+
+#include <SDL_mixer.h>
+
+#include <map>
+#include <string>
+
+using namespace ge211;
+using detail::Effect_cache;
+using detail::Resource_location;
+
+namespace {
+
+// Stands in for the file system and the decoder: each name maps to
+// the size of its samples and a modification time, and decoding makes
+// an empty chunk of that size. Names that aren't present fail to
+// decode.
+struct Fake_files
+{
+    std::map<std::string, std::pair<unsigned, long long>> files;
+    int decodes = 0;
+
+    Effect_cache::Locator locator()
+    {
+        return [this](std::string const& name) {
+            auto iter = files.find(name);
+            long long mtime = iter == files.end() ? 0 : iter->second.second;
+            return Resource_location{name, mtime};
+        };
+    }
+
+    Effect_cache::Decoder decoder()
+    {
+        return [this](std::string const& name) {
+            ++decodes;
+            auto iter = files.find(name);
+            if (iter == files.end()) return Effect_cache::Chunk_ptr();
+
+            auto chunk = new Mix_Chunk{};
+            chunk->alen = iter->second.first;
+            return Effect_cache::Chunk_ptr(chunk,
+                                           [](Mix_Chunk* c) { delete c; });
+        };
+    }
+};
+
+}  // end anonymous namespace
+
+TEST_SUITE_BEGIN("effect cache");
+
+TEST_CASE("effect cache shares decoded chunks")
+{
+    Fake_files files;
+    files.files["boom.wav"] = {1000, 1};
+    files.files["pop.wav"] = {200, 1};
+    Effect_cache cache(files.locator(), files.decoder());
+
+    auto boom1 = cache.load("boom.wav");
+    auto boom2 = cache.load("boom.wav");
+    auto pop = cache.load("pop.wav");
+
+    CHECK(boom1);
+    CHECK(boom1 == boom2);
+    CHECK(pop != boom1);
+    CHECK(files.decodes == 2);
+
+    auto stats = cache.stats();
+    CHECK(stats.entries == 2);
+    CHECK(stats.pcm_bytes == 1200);
+    CHECK(stats.pending == 0);
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 2);
+}
+
+TEST_CASE("effect cache decodes changed files again")
+{
+    Fake_files files;
+    files.files["boom.wav"] = {1000, 1};
+    Effect_cache cache(files.locator(), files.decoder());
+
+    auto old_boom = cache.load("boom.wav");
+    files.files["boom.wav"] = {500, 2};
+    auto new_boom = cache.load("boom.wav");
+
+    CHECK(new_boom != old_boom);
+    CHECK(files.decodes == 2);
+
+    auto stats = cache.stats();
+    CHECK(stats.entries == 1);
+    CHECK(stats.pcm_bytes == 500);
+    CHECK(stats.hits == 0);
+    CHECK(stats.misses == 2);
+}
+
+TEST_CASE("effect cache doesn't keep failures")
+{
+    Fake_files files;
+    Effect_cache cache(files.locator(), files.decoder());
+
+    CHECK_FALSE(cache.load("missing.wav"));
+    CHECK_FALSE(cache.load("missing.wav"));
+    CHECK(files.decodes == 2);
+
+    auto stats = cache.stats();
+    CHECK(stats.entries == 0);
+    CHECK(stats.misses == 2);
+}
+
+TEST_CASE("effect cache evicts unused chunks")
+{
+    Fake_files files;
+    files.files["boom.wav"] = {1000, 1};
+    files.files["pop.wav"] = {200, 1};
+    Effect_cache cache(files.locator(), files.decoder());
+
+    auto boom = cache.load("boom.wav");
+    cache.load("pop.wav");
+    CHECK(cache.stats().entries == 2);
+
+    cache.evict_unused();
+    auto stats = cache.stats();
+    CHECK(stats.entries == 1);
+    CHECK(stats.pcm_bytes == 1000);
+
+    // Evicted chunks are decoded again when next loaded.
+    cache.load("pop.wav");
+    CHECK(files.decodes == 3);
+
+    boom = nullptr;
+    cache.evict_unused();
+    CHECK(cache.stats().entries == 0);
+
+    cache.load("boom.wav");
+    cache.clear();
+    CHECK(cache.stats().entries == 0);
+}
+
+TEST_CASE("effect cache preloads")
+{
+    Fake_files files;
+    files.files["boom.wav"] = {1000, 1};
+    Effect_cache cache(files.locator(), files.decoder());
+
+    cache.preload("boom.wav");
+    cache.preload("boom.wav");
+
+    // Loading waits for the preload or takes it over, so the file is
+    // decoded only once either way.
+    auto boom = cache.load("boom.wav");
+    CHECK(boom);
+    CHECK(files.decodes == 1);
+
+    auto stats = cache.stats();
+    CHECK(stats.entries == 1);
+    CHECK(stats.pending == 0);
+    CHECK(stats.misses == 1);
+
+    // Already cached, so this does nothing.
+    cache.preload("boom.wav");
+    CHECK(cache.stats().pending == 0);
+}
+
+TEST_SUITE_END();
@@ -2,6 +2,11 @@
 
 #include <ge211/geometry.hxx>
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
 using namespace ge211::geometry;
 
 TEST_SUITE_BEGIN("geometry");
@@ -84,5 +89,308 @@ TEST_CASE_TEMPLATE("Posn<T> to string", T,
     CHECK( actual == expected);
 }
 
-TEST_SUITE_END();
+TEST_CASE("Rect rows and for_each_posn go in row-major order")
+{
+    Rect<int> rect{2, 5, 3, 2};
+
+    std::vector<Posn<int>> expected;
+    for (int y = 5; y < 7; ++y)
+        for (int x = 2; x < 5; ++x)
+            expected.emplace_back(x, y);
+
+    std::vector<Posn<int>> from_rows;
+    for (auto row : rect.rows()) {
+        CHECK(row.x_begin == 2);
+        CHECK(row.x_end == 5);
+        for (int x = row.x_begin; x < row.x_end; ++x)
+            from_rows.emplace_back(x, row.y);
+    }
+    CHECK(from_rows == expected);
+
+    std::vector<Posn<int>> from_each;
+    rect.for_each_posn([&](Posn<int> p) { from_each.push_back(p); });
+    CHECK(from_each == expected);
+
+    // The same positions as the column-major iterator.
+    std::vector<Posn<int>> from_iterator(rect.begin(), rect.end());
+    std::sort(from_iterator.begin(), from_iterator.end(),
+              [](Posn<int> a, Posn<int> b) {
+                  return a.y < b.y || (a.y == b.y && a.x < b.x);
+              });
+    CHECK(from_iterator == expected);
+
+    Rect<int> empty{2, 5, 3, -1};
+    CHECK(empty.rows().begin() == empty.rows().end());
+}
+
+// These are checked when compiling, so that a table of positions can be
+// computed without running any code.
+namespace {
+
+constexpr Dims<int> tile{16, 16};
+constexpr Posn<int> offsets[] = {
+        Posn<int>(the_origin),
+        Posn<int>(the_origin).right_by(tile.width),
+        Posn<int>(the_origin) + tile,
+        Posn<int>(tile * 2).up_by(8),
+};
+
+constexpr Dims<int> doubled()
+{
+    Dims<int> dims{3, 4};
+    dims += dims;
+    return dims;
+}
+
+constexpr Transform mirrored = Transform::flip_h().set_scale(2);
+
+}  // end anonymous namespace
+
+static_assert(offsets[1] == Posn<int>(16, 0), "");
+static_assert(offsets[2] == Posn<int>(16, 16), "");
+static_assert(offsets[3] == Posn<int>(32, 24), "");
+static_assert(offsets[2] - offsets[1] == Dims<int>(0, 16), "");
+static_assert(doubled() == Dims<int>(6, 8), "");
+static_assert(3 * tile == Dims<int>(48, 48), "");
+static_assert(tile < Dims<int>(17, 17) && !(tile > tile), "");
+static_assert(Dims<double>(tile).into<int>() == tile, "");
+
+static_assert(Rect<int>::from_center({50, 50}, {20, 10}) ==
+              Rect<int>(40, 45, 20, 10), "");
+static_assert(Rect<int>(1, 2, 3, 4).bottom_right() == Posn<int>(4, 6), "");
+static_assert(Rect<int>(1, 2, 3, 4).dimensions() == Dims<int>(3, 4), "");
+static_assert(Rect<int>().into<double>() == Rect<double>(0, 0, 0, 0), "");
+
+static_assert(Transform().is_identity(), "");
+static_assert(!mirrored.is_identity(), "");
+static_assert(mirrored.get_flip_h() && !mirrored.get_flip_v(), "");
+static_assert(mirrored.get_scale_x() == 2 && mirrored.get_scale_y() == 2, "");
+static_assert(mirrored != Transform::scale(2), "");
+
+TEST_CASE("geometry is usable in constant expressions")
+{
+    // The static_asserts above do the checking; this records that
+    // compile-time evaluation gives the same results as run time.
+    Posn<int> p(the_origin);
+    CHECK(p + tile == offsets[2]);
+    CHECK(Transform::flip_h().set_scale(2) == mirrored);
+}
+
+TEST_CASE("Spatial_hash rect queries")
+{
+    Spatial_hash<int> grid(10);
+
+    auto a = grid.insert({0, 0, 5, 5});
+    auto b = grid.insert({8, 8, 30, 4});
+    auto c = grid.insert({100, 100, 0, 0});
+
+    auto found = [&](Rect<int> area) {
+        std::vector<Spatial_hash<int>::Handle> result;
+        grid.query(area, [&](Spatial_hash<int>::Handle h) {
+            result.push_back(h);
+        });
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    using V = std::vector<Spatial_hash<int>::Handle>;
+
+    CHECK(grid.size() == 3);
+    CHECK(found({0, 0, 50, 50}) == V{a, b});
+    CHECK(found({5, 5, 3, 3}) == V{a, b});
+    CHECK(found({20, 0, 1, 100}) == V{b});
+    CHECK(found({100, 100, 0, 0}) == V{c});
+    CHECK(found({-1000, -1000, 3000, 3000}) == V{a, b, c});
+
+    grid.update(b, {-30, -30, 5, 5});
+    CHECK(found({20, 0, 1, 100}).empty());
+    CHECK(found({-40, -40, 10, 10}) == V{b});
+
+    grid.remove(a);
+    CHECK(found({0, 0, 5, 5}).empty());
+    CHECK(grid.size() == 2);
+    CHECK(grid.insert({1, 1, 1, 1}) == a);
+}
+
+TEST_CASE("Spatial_hash radius queries")
+{
+    Spatial_hash<double> grid(4);
+
+    auto near = grid.insert({3, 4, 1, 1});
+    grid.insert({6, 8, 1, 1});
+
+    std::vector<Spatial_hash<double>::Handle> found;
+    grid.query(Posn<double>(0, 0), 5, [&](Spatial_hash<double>::Handle h) {
+        found.push_back(h);
+    });
+
+    CHECK(found == std::vector<Spatial_hash<double>::Handle>{near});
+}
+
+TEST_CASE("Spatial_hash matches brute force")
+{
+    std::mt19937 rng(211);
+    std::uniform_real_distribution<double> coord(-500, 500);
+    std::uniform_real_distribution<double> size(0, 60);
+
+    auto random_rect = [&] {
+        return Rect<double>{coord(rng), coord(rng), size(rng), size(rng)};
+    };
+
+    Spatial_hash<double> grid(25);
+    std::vector<Rect<double>> rects;
+    std::vector<bool> live;
+
+    for (int i = 0; i < 400; ++i) {
+        rects.push_back(random_rect());
+        live.push_back(true);
+        REQUIRE(grid.insert(rects.back()) == i);
+    }
 
+    for (int round = 0; round < 5; ++round) {
+        for (size_t i = 0; i < rects.size(); i += 3) {
+            if (!live[i]) continue;
+            rects[i] = random_rect();
+            grid.update(Spatial_hash<double>::Handle(i), rects[i]);
+        }
+
+        for (size_t i = round; i < rects.size(); i += 7) {
+            if (!live[i]) continue;
+            grid.remove(Spatial_hash<double>::Handle(i));
+            live[i] = false;
+        }
+
+        for (int q = 0; q < 50; ++q) {
+            Rect<double> area = random_rect();
+            area.width *= 4;
+
+            std::vector<size_t> expected, actual;
+
+            for (size_t i = 0; i < rects.size(); ++i) {
+                Rect<double> const& r = rects[i];
+                if (live[i] &&
+                    r.x <= area.x + area.width && area.x <= r.x + r.width &&
+                    r.y <= area.y + area.height && area.y <= r.y + r.height)
+                    expected.push_back(i);
+            }
+
+            grid.query(area, [&](Spatial_hash<double>::Handle h) {
+                actual.push_back(h);
+            });
+            std::sort(actual.begin(), actual.end());
+
+            CHECK(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("Spatial_hash rejects a bad cell size")
+{
+    CHECK_THROWS_AS(Spatial_hash<int>(0), ge211::Client_logic_error);
+}
+
+TEST_CASE("transformed_bounds")
+{
+    using ge211::detail::transformed_bounds;
+
+    CHECK(transformed_bounds({10, 20}, {30, 40}, Transform()) ==
+          Rect<double>(10, 20, 30, 40));
+
+    CHECK(transformed_bounds({10, 20}, {30, 40}, Transform::scale(-2)) ==
+          Rect<double>(10, 20, 60, 80));
+
+    // A quarter turn swaps width and height about the center.
+    Rect<double> turned = transformed_bounds({0, 0}, {30, 10},
+                                             Transform::rotation(90));
+    CHECK(turned.x == doctest::Approx(10));
+    CHECK(turned.y == doctest::Approx(-10));
+    CHECK(turned.width == doctest::Approx(10));
+    CHECK(turned.height == doctest::Approx(30));
+
+    Rect<double> diamond = transformed_bounds({0, 0}, {10, 10},
+                                              Transform::rotation(45));
+    CHECK(diamond.width == doctest::Approx(10 * std::sqrt(2)));
+    CHECK(diamond.center().x == doctest::Approx(5));
+}
+
+TEST_CASE("batch transformed_bounds matches one at a time")
+{
+    using ge211::detail::transformed_bounds;
+
+    // More than one block, with a mix of rotations and scales.
+    std::mt19937 rng(211);
+    std::uniform_real_distribution<double> coord(-500, 500);
+    std::uniform_int_distribution<int> size(1, 100);
+    std::uniform_int_distribution<int> angle(-4, 4);
+
+    std::vector<Posn<double>> xys;
+    std::vector<Dims<int>> dims;
+    std::vector<Transform> transforms;
+
+    for (int i = 0; i < 150; ++i) {
+        xys.emplace_back(coord(rng), coord(rng));
+        dims.emplace_back(size(rng), size(rng));
+        transforms.push_back(Transform::rotation(45 * angle(rng))
+                                     .set_scale_x(size(rng) / 10.0)
+                                     .set_scale_y(-size(rng) / 10.0));
+    }
+
+    std::vector<Rect<double>> bounds(xys.size(), Rect<double>(0, 0, 0, 0));
+    transformed_bounds(xys.data(), dims.data(), transforms.data(),
+                       bounds.data(), xys.size());
+
+    for (size_t i = 0; i < xys.size(); ++i) {
+        Rect<double> expected = transformed_bounds(xys[i], dims[i],
+                                                   transforms[i]);
+        CHECK(bounds[i].x == doctest::Approx(expected.x));
+        CHECK(bounds[i].y == doctest::Approx(expected.y));
+        CHECK(bounds[i].width == doctest::Approx(expected.width));
+        CHECK(bounds[i].height == doctest::Approx(expected.height));
+    }
+}
+
+TEST_CASE("compose_transforms composes only the given transforms")
+{
+    std::vector<Transform> transforms{Transform::rotation(30),
+                                      Transform::scale(2),
+                                      Transform::flip_h()};
+    std::vector<uint32_t> indices{0, 2};
+
+    ge211::detail::compose_transforms(transforms.data(), indices.data(),
+                                      indices.size(),
+                                      Transform::scale(3).set_rotation(15));
+
+    CHECK(transforms[0] == Transform::rotation(45).set_scale(3));
+    CHECK(transforms[1] == Transform::scale(2));
+    CHECK(transforms[2] == Transform::flip_h().set_scale(3)
+                                              .set_rotation(15));
+}
+
+TEST_CASE("Camera maps between world and screen")
+{
+    Dims<int> window{200, 100};
+
+    Camera camera;
+    CHECK(camera.to_screen({12.5, 7}, window) == Posn<double>(12.5, 7));
+
+    camera.set_position({1000, 500});
+    CHECK(camera.to_screen({1010, 520}, window) == Posn<double>(10, 20));
+
+    // Zoom pivots about the center of the window, which shows (1100, 550).
+    camera.set_zoom(2);
+    CHECK(camera.to_screen({1100, 550}, window) == Posn<double>(100, 50));
+    CHECK(camera.to_screen({1110, 550}, window) == Posn<double>(120, 50));
+
+    // A clockwise quarter turn takes right to down.
+    camera.set_rotation(-270);
+    CHECK(camera.get_rotation() == doctest::Approx(90));
+    Posn<double> turned = camera.to_screen({1110, 550}, window);
+    CHECK(turned.x == doctest::Approx(100));
+    CHECK(turned.y == doctest::Approx(70));
+
+    Posn<double> back = camera.to_world(turned, window);
+    CHECK(back.x == doctest::Approx(1110));
+    CHECK(back.y == doctest::Approx(550));
+}
+
+TEST_SUITE_END();
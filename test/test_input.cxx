@@ -0,0 +1,115 @@
+#include "doctest.hxx"
+
+#include <ge211/input.hxx>
+
+using namespace ge211;
+using ge211::detail::Input_tracker;
+
+TEST_SUITE_BEGIN("input");
+
+TEST_CASE("key state and edges")
+{
+    Input_tracker tracker;
+    auto const& input = tracker.state();
+
+    tracker.begin_frame();
+    tracker.key_down(Key::code('a'), false);
+    tracker.key_down(Key::up(), false);
+    tracker.key_down(Key::code('a'), true);
+
+    CHECK(input.is_down(Key::code('a')));
+    CHECK(input.is_down(Key::up()));
+    CHECK_FALSE(input.is_down(Key::down()));
+    CHECK(input.was_pressed(Key::code('a')));
+    CHECK(input.pressed_keys() == std::vector<Key>{Key::code('a'), Key::up()});
+
+    tracker.begin_frame();
+    CHECK(input.is_down(Key::code('a')));
+    CHECK_FALSE(input.was_pressed(Key::code('a')));
+    CHECK(input.pressed_keys().empty());
+
+    tracker.key_up(Key::code('a'));
+    CHECK_FALSE(input.is_down(Key::code('a')));
+    CHECK(input.was_released(Key::code('a')));
+    CHECK(input.released_keys() == std::vector<Key>{Key::code('a')});
+    CHECK(input.is_down(Key::up()));
+}
+
+TEST_CASE("untracked keys")
+{
+    Input_tracker tracker;
+    tracker.begin_frame();
+    tracker.key_down(Key::other(), false);
+    tracker.key_down(Key::code(U'\u00E9'), false);
+
+    CHECK_FALSE(tracker.state().is_down(Key::other()));
+    CHECK_FALSE(tracker.state().is_down(Key::code(U'\u00E9')));
+    CHECK(tracker.state().pressed_keys().size() == 2);
+}
+
+TEST_CASE("text accumulates within a frame")
+{
+    Input_tracker tracker;
+    tracker.begin_frame();
+    tracker.text_input("he");
+    tracker.text_input("llo");
+    CHECK(tracker.state().text() == "hello");
+
+    tracker.begin_frame();
+    CHECK(tracker.state().text().empty());
+}
+
+TEST_CASE("mouse state and coalesced motion")
+{
+    Input_tracker tracker;
+    auto const& input = tracker.state();
+
+    tracker.begin_frame();
+    tracker.mouse_move({10, 10}, {10, 10});
+    tracker.mouse_move({12, 15}, {2, 5});
+    tracker.mouse_down(Mouse_button::left, {13, 15});
+
+    CHECK(input.mouse_position() == Posn<int>(13, 15));
+    CHECK(input.mouse_motion() == Dims<int>(12, 15));
+    CHECK(input.is_down(Mouse_button::left));
+    CHECK(input.was_pressed(Mouse_button::left));
+    CHECK_FALSE(input.is_down(Mouse_button::right));
+
+    tracker.begin_frame();
+    tracker.mouse_up(Mouse_button::left, {13, 15});
+
+    CHECK(input.mouse_motion() == Dims<int>(0, 0));
+    CHECK_FALSE(input.is_down(Mouse_button::left));
+    CHECK_FALSE(input.was_pressed(Mouse_button::left));
+    CHECK(input.was_released(Mouse_button::left));
+}
+
+TEST_CASE("timestamped events in order")
+{
+    Input_tracker tracker;
+    auto const& events = tracker.state().events();
+
+    Time_point t0 = Time_point::now();
+    Time_point t1 = t0 + Duration(0.004);
+    Time_point t2 = t0 + Duration(0.010);
+
+    tracker.begin_frame();
+    tracker.key_down(Key::code(' '), false, t0);
+    tracker.key_down(Key::code(' '), true, t1);
+    tracker.mouse_down(Mouse_button::right, {3, 4}, t1);
+    tracker.key_up(Key::code(' '), t2);
+
+    REQUIRE(events.size() == 3);
+    CHECK(events[0].type == Input_event::Type::key_down);
+    CHECK(events[0].key == Key::code(' '));
+    CHECK(events[0].time == t0);
+    CHECK(events[1].type == Input_event::Type::mouse_down);
+    CHECK(events[1].button == Mouse_button::right);
+    CHECK(events[1].position == Posn<int>(3, 4));
+    CHECK(events[1].time == t1);
+    CHECK(events[2].type == Input_event::Type::key_up);
+    CHECK(events[2].time - events[0].time == Duration(0.010));
+
+    tracker.begin_frame();
+    CHECK(events.empty());
+}
@@ -0,0 +1,185 @@
+#include "doctest.hxx"
+
+#include <ge211/mixer_policy.hxx>
+
+#include <vector>
+
+using namespace ge211;
+using namespace ge211::detail;
+
+using Policy = Mixer::Voice_stealing;
+
+TEST_SUITE_BEGIN("mixer policy");
+
+namespace {
+
+// Stand-ins for the samples of two different effects.
+int const boom = 1, pop = 2;
+
+}  // end anonymous namespace
+
+TEST_CASE("instance limits")
+{
+    // 0 means no limit.
+    CHECK(within_instance_limit(0, 0));
+    CHECK(within_instance_limit(100, 0));
+
+    CHECK(within_instance_limit(0, 1));
+    CHECK_FALSE(within_instance_limit(1, 1));
+    CHECK(within_instance_limit(2, 3));
+    CHECK_FALSE(within_instance_limit(3, 3));
+    CHECK_FALSE(within_instance_limit(4, 3));
+}
+
+TEST_CASE("no stealing")
+{
+    std::vector<Steal_candidate> playing{
+            {0, 0, 128, 1, &boom},
+    };
+
+    CHECK(choose_victim(Policy::none, playing, 0, nullptr) == -1);
+    CHECK(choose_victim(Policy::oldest, {}, 0, nullptr) == -1);
+}
+
+TEST_CASE("steal oldest")
+{
+    std::vector<Steal_candidate> playing{
+            {0, 0, 128, 7, &boom},
+            {1, 0, 10, 3, &pop},
+            {2, 0, 128, 5, &boom},
+    };
+
+    CHECK(choose_victim(Policy::oldest, playing, 0, nullptr) == 1);
+
+    // Over the instance limit, only copies of the same effect qualify.
+    CHECK(choose_victim(Policy::oldest, playing, 0, &boom) == 2);
+    CHECK(choose_victim(Policy::oldest, playing, 0, &pop) == 1);
+}
+
+TEST_CASE("steal quietest")
+{
+    std::vector<Steal_candidate> playing{
+            {0, 0, 128, 1, &boom},
+            {1, 0, 32, 3, &pop},
+            {2, 0, 32, 2, &boom},
+            {3, 0, 64, 4, &boom},
+    };
+
+    // Ties in volume go to the oldest.
+    CHECK(choose_victim(Policy::quietest, playing, 0, nullptr) == 2);
+    CHECK(choose_victim(Policy::quietest, playing, 0, &pop) == 1);
+
+    playing[2].volume = 100;
+    CHECK(choose_victim(Policy::quietest, playing, 0, nullptr) == 1);
+    CHECK(choose_victim(Policy::quietest, playing, 0, &boom) == 3);
+}
+
+TEST_CASE("stealing respects priority")
+{
+    std::vector<Steal_candidate> playing{
+            {0, 5, 0, 1, &boom},
+            {1, 2, 128, 9, &pop},
+            {2, 2, 128, 4, &pop},
+            {3, 3, 0, 2, &boom},
+    };
+
+    // Lowest priority first, before age or volume.
+    CHECK(choose_victim(Policy::oldest, playing, 5, nullptr) == 2);
+    CHECK(choose_victim(Policy::quietest, playing, 5, nullptr) == 2);
+
+    // Higher priorities are never stolen.
+    CHECK(choose_victim(Policy::oldest, playing, 1, nullptr) == -1);
+    CHECK(choose_victim(Policy::oldest, playing, 3, &boom) == 3);
+    CHECK(choose_victim(Policy::oldest, playing, 2, &boom) == -1);
+    CHECK(choose_victim(Policy::oldest, playing, 5, &boom) == 3);
+}
+
+TEST_CASE("spatialize attenuates with distance")
+{
+    Mixer::Attenuation attenuation;
+    attenuation.reference_distance = 100;
+    attenuation.max_distance = 1000;
+    Posn<double> listener{40, 30};
+
+    auto at = [&](double dy) {
+        return spatialize(listener, {listener.x, listener.y + dy},
+                          attenuation);
+    };
+
+    // Full volume within the reference distance.
+    for (double dy : {0.0, 50.0, -100.0}) {
+        auto panning = at(dy);
+        CHECK(panning.audible);
+        CHECK(panning.left == 255);
+        CHECK(panning.right == 255);
+    }
+
+    // Then linear down to zero at the maximum distance.
+    CHECK(at(550).left == 128);
+    CHECK(at(550).right == 128);
+    CHECK(at(-775).left == 64);
+    CHECK(at(999).audible);
+    CHECK(at(999).left == 0);
+    CHECK(at(999).right == 0);
+
+    // Where it's silent, so it's culled from there on.
+    CHECK_FALSE(at(1000).audible);
+    CHECK_FALSE(at(-1000).audible);
+    CHECK_FALSE(at(1000.5).audible);
+    CHECK_FALSE(at(-5000).audible);
+    CHECK_FALSE(spatialize(listener, {listener.x + 800, listener.y + 800},
+                           attenuation).audible);
+}
+
+TEST_CASE("spatialize pans with horizontal offset")
+{
+    // Keep everything within the reference distance, so that only
+    // panning changes the volume.
+    Mixer::Attenuation attenuation;
+    attenuation.reference_distance = 4000;
+    attenuation.max_distance = 5000;
+    attenuation.pan_distance = 500;
+    Posn<double> listener{0, 0};
+
+    auto at = [&](double dx) {
+        return spatialize(listener, {dx, 100}, attenuation);
+    };
+
+    // Hard left and right at the pan distance, and clamped beyond it.
+    for (double dx : {500.0, 2000.0}) {
+        CHECK(at(dx).left == 0);
+        CHECK(at(dx).right == 255);
+        CHECK(at(-dx).left == 255);
+        CHECK(at(-dx).right == 0);
+    }
+
+    // Constant power: the far ear gets sqrt(2) cos(3 pi / 8) of full
+    // volume halfway over, while the near ear is capped at full.
+    CHECK(at(250).left == 138);
+    CHECK(at(250).right == 255);
+    CHECK(at(-250).left == 255);
+    CHECK(at(-250).right == 138);
+
+    // Symmetric about the listener.
+    for (double dx : {10.0, 100.0, 333.0}) {
+        CHECK(at(dx).left == at(-dx).right);
+        CHECK(at(dx).right == at(-dx).left);
+        CHECK(at(dx).left < 255);
+    }
+}
+
+TEST_CASE("spatialize combines panning and attenuation")
+{
+    Mixer::Attenuation attenuation;
+    attenuation.reference_distance = 100;
+    attenuation.max_distance = 1000;
+    attenuation.pan_distance = 500;
+
+    // 550 away, so half volume, and panned hard right.
+    auto panning = spatialize({0, 0}, {550, 0}, attenuation);
+    CHECK(panning.audible);
+    CHECK(panning.left == 0);
+    CHECK(panning.right == 128);
+}
+
+TEST_SUITE_END();
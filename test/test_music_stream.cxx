@@ -0,0 +1,92 @@
+#include "doctest.hxx"
+
+#include <ge211/music_stream.hxx>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using ge211::detail::Music_stream;
+
+namespace {
+
+// A file of predictable bytes, larger than what the stream keeps in
+// memory, that is removed when the test is done.
+struct Temp_file
+{
+    static constexpr size_t size = 2 * 1024 * 1024 + 123;
+
+    std::string path = "test_music_stream.bin";
+
+    Temp_file()
+    {
+        std::vector<char> data(size);
+        for (size_t i = 0; i < size; ++i) data[i] = byte_at(i);
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        REQUIRE(file);
+        REQUIRE(std::fwrite(data.data(), 1, size, file) == size);
+        std::fclose(file);
+    }
+
+    ~Temp_file()
+    {
+        std::remove(path.c_str());
+    }
+
+    static char byte_at(size_t i)
+    {
+        return char((i * 2654435761u) >> 13);
+    }
+
+    static bool matches(std::vector<char> const& buf, size_t offset)
+    {
+        for (size_t i = 0; i < buf.size(); ++i)
+            if (buf[i] != byte_at(offset + i)) return false;
+        return true;
+    }
+};
+
+constexpr size_t Temp_file::size;
+
+}  // end anonymous namespace
+
+TEST_SUITE_BEGIN("music stream");
+
+TEST_CASE("real-time music stream seeks past the ring")
+{
+    Temp_file file;
+    std::shared_ptr<Music_stream> stream;
+    SDL_RWops* rw = Music_stream::open(file.path, stream);
+    REQUIRE(rw);
+    stream->start_realtime();
+
+    size_t const offset = 1024 * 1024;
+    REQUIRE(SDL_RWseek(rw, offset, RW_SEEK_SET) == Sint64(offset));
+
+    // Reads are never short before the end, even if the reader falls
+    // behind; then they're padded, and the following reads pick up at
+    // the right place.
+    std::vector<char> buf(4096);
+    for (size_t pos = offset; pos < offset + 64 * 1024; pos += buf.size()) {
+        auto underruns = stream->underruns();
+        CHECK(SDL_RWread(rw, buf.data(), 1, buf.size()) == buf.size());
+        if (stream->underruns() == underruns)
+            CHECK(Temp_file::matches(buf, pos));
+    }
+
+    // The start of the file is always at hand.
+    REQUIRE(SDL_RWseek(rw, 100, RW_SEEK_SET) == 100);
+    CHECK(SDL_RWread(rw, buf.data(), 1, buf.size()) == buf.size());
+    CHECK(Temp_file::matches(buf, 100));
+
+    // Only the end of the file makes a read short.
+    auto near_end = Sint64(Temp_file::size - 100);
+    REQUIRE(SDL_RWseek(rw, -100, RW_SEEK_END) == near_end);
+    CHECK(SDL_RWread(rw, buf.data(), 1, buf.size()) == 100);
+    CHECK(SDL_RWread(rw, buf.data(), 1, buf.size()) == 0);
+
+    CHECK(SDL_RWclose(rw) == 0);
+}
+
+TEST_SUITE_END();
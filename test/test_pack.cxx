@@ -0,0 +1,65 @@
+#include "doctest.hxx"
+
+#include <ge211/error.hxx>
+#include <ge211/pack.hxx>
+
+#include <sstream>
+
+using ge211::detail::Resource_pack;
+
+TEST_SUITE_BEGIN("pack");
+
+TEST_CASE("Resource_pack round trip")
+{
+    std::stringstream buf;
+    Resource_pack::write(buf, {
+            {"tiles.png", "PNG data"},
+            {"sub/dir/pop.ogg", std::string("Ogg\0data", 8)},
+            {"empty.txt", ""},
+    });
+
+    Resource_pack pack;
+    REQUIRE(pack.load(buf));
+    CHECK(pack.size() == 3);
+
+    Resource_pack::Blob blob{};
+
+    REQUIRE(pack.find("tiles.png", blob));
+    CHECK(std::string(blob.data, blob.size) == "PNG data");
+
+    REQUIRE(pack.find("sub/dir/pop.ogg", blob));
+    CHECK(std::string(blob.data, blob.size) == std::string("Ogg\0data", 8));
+
+    REQUIRE(pack.find("empty.txt", blob));
+    CHECK(blob.size == 0);
+
+    CHECK_FALSE(pack.find("missing.png", blob));
+    CHECK_FALSE(pack.find("tiles.pn", blob));
+}
+
+TEST_CASE("Resource_pack rejects malformed input")
+{
+    Resource_pack pack;
+
+    std::istringstream garbage("this is not a pack file");
+    CHECK_FALSE(pack.load(garbage));
+    CHECK(pack.empty());
+
+    std::stringstream buf;
+    Resource_pack::write(buf, {{"a", "b"}});
+    std::string truncated = buf.str();
+    truncated.resize(truncated.size() - 20);
+
+    std::istringstream in(truncated);
+    CHECK_FALSE(pack.load(in));
+    CHECK(pack.empty());
+}
+
+TEST_CASE("Resource_pack::write rejects duplicate names")
+{
+    std::stringstream buf;
+    CHECK_THROWS_AS(Resource_pack::write(buf, {{"a", "1"}, {"a", "2"}}),
+                    ge211::Client_logic_error);
+}
+
+TEST_SUITE_END();
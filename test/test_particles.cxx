@@ -0,0 +1,78 @@
+#include "doctest.hxx"
+
+#include <ge211/particles.hxx>
+#include <ge211/error.hxx>
+
+using namespace ge211;
+
+TEST_SUITE_BEGIN("particles");
+
+TEST_CASE("particles are emitted up to capacity")
+{
+    Particle_system particles(3, {100, 100});
+
+    CHECK(particles.empty());
+    CHECK(particles.capacity() == 3);
+    CHECK(particles.dimensions() == Dims<int>(100, 100));
+
+    CHECK(particles.emit({10, 10}, {0, 0}, Color::white(), 1));
+    CHECK(particles.emit({20, 10}, {0, 0}, Color::white(), 1));
+    CHECK(particles.emit({30, 10}, {0, 0}, Color::white(), 1));
+    CHECK_FALSE(particles.emit({40, 10}, {0, 0}, Color::white(), 1));
+    CHECK(particles.size() == 3);
+
+    particles.clear();
+    CHECK(particles.empty());
+}
+
+TEST_CASE("particles outside the extent are not emitted")
+{
+    Particle_system particles(10, {100, 50});
+
+    CHECK_FALSE(particles.emit({-1, 10}, {0, 0}, Color::white(), 1));
+    CHECK_FALSE(particles.emit({10, 50}, {0, 0}, Color::white(), 1));
+    CHECK(particles.empty());
+}
+
+TEST_CASE("particles die when their lifetimes are up")
+{
+    Particle_system particles(10, {100, 100});
+
+    particles.emit({10, 10}, {0, 0}, Color::white(), 0.5);
+    particles.emit({20, 10}, {0, 0}, Color::white(), 2);
+    particles.emit({30, 10}, {0, 0}, Color::white(), 0.75);
+    particles.emit({40, 10}, {0, 0}, Color::white(), 2);
+
+    particles.update(0.25);
+    CHECK(particles.size() == 4);
+
+    // Removing the first particle moves the last into its place, which
+    // must still be checked.
+    particles.update(0.5);
+    CHECK(particles.size() == 2);
+
+    particles.update(2);
+    CHECK(particles.empty());
+}
+
+TEST_CASE("particles move and die when they leave the extent")
+{
+    Particle_system particles(10, {100, 10});
+
+    particles.emit({50, 5}, {20, 0}, Color::white(), 10);
+    particles.update(1);
+    CHECK(particles.size() == 1);
+
+    particles.set_gravity({0, 100});
+    CHECK(particles.get_gravity() == Dims<float>(0, 100));
+
+    // Falls 50 px/s * 0.5 s = 25 px, out the bottom.
+    particles.update(0.5);
+    CHECK(particles.empty());
+}
+
+TEST_CASE("particle system arguments are checked")
+{
+    CHECK_THROWS_AS(Particle_system(10, {0, 10}), Client_logic_error);
+    CHECK_THROWS_AS(Particle_system(10, {10, 10}, 0), Client_logic_error);
+}
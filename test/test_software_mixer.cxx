@@ -0,0 +1,122 @@
+#include "doctest.hxx"
+
+#include <ge211/software_mixer.hxx>
+
+#include <vector>
+
+using namespace ge211::detail;
+
+TEST_SUITE_BEGIN("software mixer");
+
+namespace {
+
+Voice_state make_voice(std::vector<int16_t> const& samples, int channels)
+{
+    Voice_state voice;
+    voice.samples = samples.data();
+    voice.frames  = samples.size() / size_t(channels);
+    return voice;
+}
+
+}
+
+TEST_CASE("add_and_clip rounds and saturates")
+{
+    std::vector<float> acc{100, -100, 30000, -30000, 0.6f, -0.6f};
+    std::vector<int16_t> stream{1, 2, 10000, -10000, 7, 7};
+
+    add_and_clip(acc.data(), stream.data(), stream.size());
+
+    CHECK(stream == std::vector<int16_t>{101, -98, 32767, -32768, 8, 6});
+}
+
+TEST_CASE("mix_voice at unity pitch and gain")
+{
+    std::vector<int16_t> samples{1, 2, 3, 4, 5, 6};
+    auto voice = make_voice(samples, 2);
+
+    std::vector<float> acc(4, 10);
+    CHECK(mix_voice(voice, acc.data(), 2, 2));
+    CHECK(acc == std::vector<float>{11, 12, 13, 14});
+
+    // Only one frame is left, so the voice ends partway through.
+    std::vector<float> rest(4, 0);
+    CHECK_FALSE(mix_voice(voice, rest.data(), 2, 2));
+    CHECK(rest == std::vector<float>{5, 6, 0, 0});
+}
+
+TEST_CASE("mix_voice ramps gain linearly")
+{
+    std::vector<int16_t> samples(8, 100);
+    auto voice = make_voice(samples, 1);
+    voice.gain        = 0;
+    voice.target_gain = 1;
+    voice.ramp_frames = 4;
+
+    std::vector<float> acc(6, 0);
+    CHECK(mix_voice(voice, acc.data(), 6, 1));
+
+    CHECK(acc[0] == doctest::Approx(0));
+    CHECK(acc[1] == doctest::Approx(25));
+    CHECK(acc[2] == doctest::Approx(50));
+    CHECK(acc[3] == doctest::Approx(75));
+    CHECK(acc[4] == doctest::Approx(100));
+    CHECK(acc[5] == doctest::Approx(100));
+    CHECK(voice.ramp_frames == 0);
+    CHECK(voice.gain == 1);
+}
+
+TEST_CASE("mix_voice resamples")
+{
+    std::vector<int16_t> samples{0, 10, 20, 30};
+
+    SUBCASE("faster")
+    {
+        auto voice = make_voice(samples, 1);
+        voice.step = 2;
+
+        std::vector<float> acc(3, 0);
+        CHECK_FALSE(mix_voice(voice, acc.data(), 3, 1));
+        CHECK(acc == std::vector<float>{0, 20, 0});
+    }
+
+    SUBCASE("slower")
+    {
+        auto voice = make_voice(samples, 1);
+        voice.step = 0.5;
+
+        std::vector<float> acc(4, 0);
+        CHECK(mix_voice(voice, acc.data(), 4, 1));
+        CHECK(acc[1] == doctest::Approx(5));
+        CHECK(acc[3] == doctest::Approx(15));
+    }
+}
+
+TEST_CASE("mix_voice loops")
+{
+    std::vector<int16_t> samples{1, 2, 3};
+    auto voice = make_voice(samples, 1);
+    voice.loop = true;
+
+    std::vector<float> acc(7, 0);
+    CHECK(mix_voice(voice, acc.data(), 7, 1));
+    CHECK(acc == std::vector<float>{1, 2, 3, 1, 2, 3, 1});
+}
+
+TEST_CASE("set_voice_pan")
+{
+    Voice_state voice;
+
+    set_voice_pan(voice, 0);
+    CHECK(voice.left == doctest::Approx(1));
+    CHECK(voice.right == doctest::Approx(1));
+
+    set_voice_pan(voice, -1);
+    CHECK(voice.right == doctest::Approx(0));
+    CHECK(voice.left * voice.left == doctest::Approx(2));
+
+    set_voice_pan(voice, 0.5f);
+    CHECK(voice.left * voice.left + voice.right * voice.right ==
+          doctest::Approx(2));
+    CHECK(voice.right > voice.left);
+}
@@ -0,0 +1,108 @@
+#include "doctest.hxx"
+
+#include <ge211/sprites.hxx>
+#include <ge211/error.hxx>
+
+using namespace ge211;
+
+namespace {
+
+// A sprite that is never rendered, so it needs only dimensions.
+struct Fake_sprite : Sprite
+{
+    Dims<int> dimensions() const override
+    { return {8, 8}; }
+
+private:
+    void render(detail::Renderer&, Posn<int>, Transform const&) const override
+    { }
+};
+
+std::vector<Posn<int>> make_positions(int count)
+{
+    std::vector<Posn<int>> result;
+    for (int i = 0; i < count; ++i)
+        result.push_back({10 * i, 0});
+    return result;
+}
+
+}  // end anonymous namespace
+
+TEST_SUITE_BEGIN("sprites");
+
+TEST_CASE("placed sprites add runs")
+{
+    Fake_sprite sprite;
+    detail::Placed_sprites placed;
+    auto positions = make_positions(5);
+
+    placed.add_run(sprite, positions, 3, nullptr, nullptr);
+    CHECK(placed.size() == 5);
+
+    std::vector<int> zs{5, 4, 3, 2, 1};
+    placed.add_run(sprite, positions, 0, zs.data(), nullptr);
+    CHECK(placed.size() == 10);
+
+    std::vector<Transform> transforms(5, Transform::flip_h());
+    transforms[2] = Transform();
+    placed.add_run(sprite, positions, 0, zs.data(), transforms.data());
+    CHECK(placed.size() == 15);
+
+    CHECK(placed.order(false, {100, 100}) == 15);
+
+    placed.clear();
+    CHECK(placed.size() == 0);
+}
+
+TEST_CASE("placed sprites add many small runs")
+{
+    Fake_sprite sprite;
+    detail::Placed_sprites placed;
+    auto positions = make_positions(3);
+
+    for (int i = 0; i < 1000; ++i)
+        placed.add_run(sprite, positions, i, nullptr, nullptr);
+
+    CHECK(placed.size() == 3000);
+    // Each run is 10 pixels apart, so only the first two sprites of
+    // each run fall within a 16-pixel-wide screen.
+    CHECK(placed.order(true, {16, 16}) == 2000);
+}
+
+TEST_CASE("sprite set add sprites")
+{
+    Fake_sprite sprite;
+    sprites::Render_target_sprite target({100, 100});
+    auto positions = make_positions(4);
+
+    Sprite_set& set = target.redraw();
+
+    CHECK_NOTHROW(set.add_sprites(sprite, positions));
+    CHECK_NOTHROW(set.add_sprites(sprite, positions, 2));
+    CHECK_NOTHROW(set.add_sprites(sprite, positions, {1, 2, 3, 4}));
+    CHECK_NOTHROW(set.add_sprites(sprite, positions, {1, 2, 3, 4},
+                                  std::vector<Transform>(4)));
+    CHECK_NOTHROW(set.add_sprites(sprite, {}, std::vector<int>{}));
+}
+
+TEST_CASE("sprite set add sprites length mismatch")
+{
+    Fake_sprite sprite;
+    sprites::Render_target_sprite target({100, 100});
+    auto positions = make_positions(4);
+
+    Sprite_set& set = target.redraw();
+
+    CHECK_THROWS_AS(set.add_sprites(sprite, positions, {1, 2, 3}),
+                    Client_logic_error);
+    CHECK_THROWS_AS(set.add_sprites(sprite, positions, {1, 2, 3, 4, 5}),
+                    Client_logic_error);
+    CHECK_THROWS_AS(set.add_sprites(sprite, positions, {1, 2, 3},
+                                    std::vector<Transform>(4)),
+                    Client_logic_error);
+    CHECK_THROWS_AS(set.add_sprites(sprite, positions, {1, 2, 3, 4},
+                                    std::vector<Transform>(3)),
+                    Client_logic_error);
+}
+
+TEST_SUITE_END();
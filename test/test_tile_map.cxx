@@ -0,0 +1,82 @@
+#include "doctest.hxx"
+
+#include <ge211/tile_map.hxx>
+#include <ge211/error.hxx>
+
+using namespace ge211;
+
+namespace {
+
+// A tileset that is never rendered, so it needs only dimensions.
+struct Fake_tileset : Sprite
+{
+    Dims<int> dims;
+
+    explicit Fake_tileset(Dims<int> dims)
+            : dims(dims)
+    { }
+
+    Dims<int> dimensions() const override
+    { return dims; }
+
+private:
+    void render(detail::Renderer&, Posn<int>, Transform const&) const override
+    { }
+};
+
+}  // end anonymous namespace
+
+TEST_SUITE_BEGIN("tile_map");
+
+TEST_CASE("tile map dimensions")
+{
+    Fake_tileset tileset({128, 40});
+    Tile_map map(tileset, {16, 16}, {100, 50});
+
+    CHECK(map.map_dimensions() == Dims<int>(100, 50));
+    CHECK(map.tile_dimensions() == Dims<int>(16, 16));
+    CHECK(map.dimensions() == Dims<int>(1600, 800));
+
+    // Leftover pixels at the edge of the tileset don't make tiles.
+    CHECK(map.tile_count() == 16);
+}
+
+TEST_CASE("tile map cells")
+{
+    Fake_tileset tileset({64, 64});
+    Tile_map map(tileset, {16, 16}, {40, 40});
+
+    CHECK(map.get_tile({0, 0}) == Tile_map::no_tile);
+    CHECK(map.get_tile({39, 39}) == Tile_map::no_tile);
+
+    map.set_tile({3, 35}, 15).set_tile({4, 35}, 0);
+    CHECK(map.get_tile({3, 35}) == 15);
+    CHECK(map.get_tile({4, 35}) == 0);
+    CHECK(map.get_tile({3, 34}) == Tile_map::no_tile);
+
+    map.fill(7);
+    CHECK(map.get_tile({3, 35}) == 7);
+    CHECK(map.get_tile({39, 0}) == 7);
+
+    map.set_tile({39, 0}, Tile_map::no_tile);
+    CHECK(map.get_tile({39, 0}) == Tile_map::no_tile);
+}
+
+TEST_CASE("tile map arguments are checked")
+{
+    Fake_tileset tileset({64, 64});
+    Tile_map map(tileset, {16, 16}, {10, 10});
+
+    CHECK_THROWS_AS(map.get_tile({10, 0}), Client_logic_error);
+    CHECK_THROWS_AS(map.get_tile({0, -1}), Client_logic_error);
+    CHECK_THROWS_AS(map.set_tile({0, 0}, 16), Client_logic_error);
+    CHECK_THROWS_AS(map.set_tile({0, 0}, -2), Client_logic_error);
+    CHECK_THROWS_AS(map.fill(100), Client_logic_error);
+
+    CHECK_THROWS_AS(Tile_map(tileset, {0, 16}, {10, 10}),
+                    Client_logic_error);
+    CHECK_THROWS_AS(Tile_map(tileset, {16, 16}, {10, 0}),
+                    Client_logic_error);
+    CHECK_THROWS_AS(Tile_map(tileset, {128, 16}, {10, 10}),
+                    Client_logic_error);
+}
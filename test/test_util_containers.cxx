@@ -1,8 +1,12 @@
 #include "doctest.hxx"
 
 #include <ge211/util/ring_buffer.hxx>
+#include <ge211/util/spsc_queue.hxx>
+
+#include <thread>
 
 using util::containers::Ring_buffer;
+using util::containers::Spsc_queue;
 
 TEST_SUITE_BEGIN("util::containers");
 
@@ -95,5 +99,64 @@ TEST_CASE("Ring_buffer (start filled)")
     CHECK(buf.rotate(14) == 11);
 }
 
+TEST_CASE("Spsc_queue (single thread)")
+{
+    Spsc_queue<int, 3> queue;
+    int out = 0;
+
+    CHECK(queue.empty());
+    CHECK_FALSE(queue.try_pop(out));
+
+    CHECK(queue.try_push(1));
+    CHECK(queue.try_push(2));
+    CHECK(queue.try_push(3));
+    CHECK_FALSE(queue.try_push(4));
+    CHECK_FALSE(queue.empty());
+
+    CHECK(queue.try_pop(out));
+    CHECK(out == 1);
+    CHECK(queue.try_push(5));
+
+    CHECK(queue.try_pop(out));
+    CHECK(out == 2);
+    CHECK(queue.try_pop(out));
+    CHECK(out == 3);
+    CHECK(queue.try_pop(out));
+    CHECK(out == 5);
+    CHECK_FALSE(queue.try_pop(out));
+    CHECK(queue.empty());
+}
+
+TEST_CASE("Spsc_queue (two threads)")
+{
+    Spsc_queue<int, 16> queue;
+    int const count = 100000;
+
+    std::thread producer([&] {
+        for (int i = 0; i < count; ) {
+            // Yield rather than spin, in case there is only one CPU.
+            if (queue.try_push(i)) ++i;
+            else std::this_thread::yield();
+        }
+    });
+
+    int expected = 0;
+    bool in_order = true;
+    while (expected < count) {
+        int out;
+        if (queue.try_pop(out)) {
+            in_order = in_order && out == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    CHECK(in_order);
+    CHECK(queue.empty());
+}
+
 TEST_SUITE_END();
 
@@ -17,7 +17,9 @@ struct Delete_ptr_tester
 struct Lazy_ptr_tester
 {
     static bool forced;
+    int value = 0;
     Lazy_ptr_tester() { forced = true; }
+    explicit Lazy_ptr_tester(int v) : value(v) { forced = true; }
 };
 
 bool Lazy_ptr_tester::forced, Delete_ptr_tester::deleted;
@@ -84,4 +86,17 @@ TEST_CASE("Lazy_ptr")
     CHECK(ptr.is_forced());
 }
 
+TEST_CASE("Lazy_ptr::force")
+{
+    using T = Lazy_ptr_tester;
+
+    T::forced = false;
+    Lazy_ptr<T> ptr;
+
+    CHECK(ptr.force(5).value == 5);
+    CHECK(T::forced);
+    CHECK(ptr.force(7).value == 5);
+    CHECK(ptr->value == 5);
+}
+
 TEST_SUITE_END();
@@ -0,0 +1,115 @@
+// ge211-audio-latency: measures the mixer's output latency without a
+// display or sound card.
+//
+// Usage: ge211-audio-latency [BUFFER_FRAMES [FREQUENCY]]
+//
+// Opens the mixer with the given buffer size (default 1024 frames) and
+// sample rate (default SDL_mixer's), plays a sound effect, mixes for about
+// two seconds, and then reports the latency that the mixer reports and
+// the interval it measured between the audio device's requests for more
+// audio.
+//
+// Unless SDL_AUDIODRIVER and SDL_VIDEODRIVER are already set, this uses
+// SDL's "dummy" drivers, which consume audio at the real-time rate but
+// don't play it. To check what a real device does, run with, say,
+// SDL_AUDIODRIVER=pulseaudio; to capture the output to a file, use
+// SDL_AUDIODRIVER=disk.
+
+#include <ge211.hxx>
+
+#include <SDL.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace ge211;
+
+class Latency_probe : public Abstract_game
+{
+public:
+    explicit Latency_probe(Mixer::Config config)
+            : config_(config)
+    { }
+
+    int status = 1;
+
+protected:
+    Mixer::Config initial_mixer_config() const override
+    {
+        return config_;
+    }
+
+    void on_start() override
+    {
+        if (!mixer().is_enabled()) {
+            std::cerr << "Could not open the audio device\n";
+            quit();
+            return;
+        }
+
+        effect_.load("pop.ogg", mixer());
+        mixer().play_effect(effect_);
+        elapsed_ = 0;
+    }
+
+    void on_frame(double seconds) override
+    {
+        elapsed_ += seconds;
+        if (elapsed_ < run_seconds) return;
+
+        auto const& actual = mixer().get_config();
+        std::cout
+                << "requested:       " << config_.buffer_frames
+                << " frames at ";
+        if (config_.frequency)
+            std::cout << config_.frequency << " Hz\n";
+        else
+            std::cout << "the default rate\n";
+        std::cout
+                << "obtained:        " << actual.buffer_frames
+                << " frames at " << actual.frequency << " Hz, "
+                << actual.output_channels << " channels\n"
+                << "reported:        "
+                << mixer().get_latency().seconds() * 1000 << " ms\n"
+                << "measured period: "
+                << mixer().get_measured_mix_period().seconds() * 1000
+                << " ms\n";
+
+        status = mixer().get_measured_mix_period() > Duration(0) ? 0 : 1;
+        quit();
+    }
+
+    void draw(Sprite_set&) override
+    { }
+
+private:
+    static constexpr double run_seconds = 2.0;
+
+    Mixer::Config config_;
+    Sound_effect effect_;
+    double elapsed_ = 0;
+};
+
+constexpr double Latency_probe::run_seconds;
+
+int main(int argc, char* argv[])
+{
+    Mixer::Config config;
+
+    try {
+        if (argc > 1) config.buffer_frames = std::stoi(argv[1]);
+        if (argc > 2) config.frequency = std::stoi(argv[2]);
+    } catch (std::exception const&) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [BUFFER_FRAMES [FREQUENCY]]\n";
+        return 2;
+    }
+
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+    Latency_probe probe(config);
+    probe.run();
+    return probe.status;
+}
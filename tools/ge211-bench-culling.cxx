@@ -0,0 +1,133 @@
+// ge211-bench-culling: measures what culling off-screen sprites saves
+// in a scrolling world.
+//
+// Usage: ge211-bench-culling [SPRITES [FRAMES]]
+//
+// Scatters SPRITES small sprites (default 20,000) over a world ten
+// screens wide, adds all of them to the Sprite_set every frame while
+// scrolling across it, and reports the engine's load and the number of
+// sprites drawn and culled, first with culling on and then with it
+// off, for FRAMES frames each (default 300).
+//
+// Unless SDL_VIDEODRIVER is already set, this uses SDL's "dummy" video
+// driver, which renders in software without a display.
+
+#include <ge211.hxx>
+
+#include <SDL.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ge211;
+
+namespace {
+
+Dims<int> const screen{800, 600};
+Dims<int> const world{10 * screen.width, screen.height};
+
+}  // end anonymous namespace
+
+class Culling_bench : public Abstract_game
+{
+public:
+    Culling_bench(int sprites, int frames)
+            : sprite_count_(sprites),
+              frames_(frames)
+    { }
+
+protected:
+    Dims<int> initial_window_dimensions() const override
+    {
+        return screen;
+    }
+
+    void on_start() override
+    {
+        std::mt19937 rng(211);
+        std::uniform_int_distribution<int> x(0, world.width - 16);
+        std::uniform_int_distribution<int> y(0, world.height - 16);
+
+        for (int i = 0; i < sprite_count_; ++i)
+            positions_.push_back({x(rng), y(rng)});
+    }
+
+    void on_frame(double) override
+    {
+        ++frame_;
+
+        // Skip the first frame of each phase, since the counts and load
+        // describe the frame before.
+        if (frame_ % frames_ != 1) {
+            load_ += get_load_percent();
+            drawn_ += get_drawn_sprite_count();
+            culled_ += get_culled_sprite_count();
+        }
+
+        if (frame_ % frames_ != 0) return;
+
+        report_();
+
+        if (get_sprite_culling())
+            set_sprite_culling(false);
+        else
+            quit();
+    }
+
+    void draw(Sprite_set& set) override
+    {
+        int scroll = (frame_ * 8) % (world.width - screen.width);
+
+        for (Posn<int> posn : positions_)
+            set.add_sprite(tile_, posn.left_by(scroll));
+    }
+
+private:
+    void report_()
+    {
+        double samples = frames_ - 1;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "culling " << (get_sprite_culling() ? "on: " : "off:")
+                  << "  load " << std::setw(5) << load_ / samples << "%"
+                  << "  drawn " << std::setw(8) << drawn_ / samples
+                  << "  culled " << std::setw(8) << culled_ / samples
+                  << '\n';
+
+        load_ = drawn_ = culled_ = 0;
+    }
+
+    int sprite_count_;
+    int frames_;
+    int frame_ = 0;
+    std::vector<Posn<int>> positions_;
+    Rectangle_sprite tile_{{16, 16}, Color::medium_green()};
+
+    double load_ = 0;
+    double drawn_ = 0;
+    double culled_ = 0;
+};
+
+int main(int argc, char* argv[])
+{
+    int sprites = 20000;
+    int frames = 300;
+
+    try {
+        if (argc > 1) sprites = std::stoi(argv[1]);
+        if (argc > 2) frames = std::stoi(argv[2]);
+    } catch (std::exception const&) {
+        std::cerr << "Usage: " << argv[0] << " [SPRITES [FRAMES]]\n";
+        return 2;
+    }
+
+    if (frames < 2) frames = 2;
+
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+    Culling_bench(sprites, frames).run();
+}
@@ -0,0 +1,131 @@
+// ge211-bench-particles: measures updating and rendering a large
+// Particle_system.
+//
+// Usage: ge211-bench-particles [PARTICLES [FRAMES]]
+//
+// Keeps PARTICLES particles (default 200,000) alive under gravity,
+// emitting new ones as old ones die, for FRAMES frames (default 300),
+// and then reports the average time per frame spent in
+// Particle_system::update and the engine's load. At 60 frames per
+// second, a load under 100% means the frame rate can be sustained.
+//
+// Unless SDL_VIDEODRIVER is already set, this uses SDL's "dummy" video
+// driver, which renders in software without a display.
+
+#include <ge211.hxx>
+
+#include <SDL.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace ge211;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Dims<int> const screen{1024, 768};
+
+}  // end anonymous namespace
+
+class Particles_bench : public Abstract_game
+{
+public:
+    Particles_bench(int particles, int frames)
+            : particles_(size_t(particles), screen),
+              frames_(frames)
+    {
+        particles_.set_gravity({0, 120});
+    }
+
+protected:
+    Dims<int> initial_window_dimensions() const override
+    {
+        return screen;
+    }
+
+    void on_frame(double dt) override
+    {
+        ++frame_;
+
+        // Skip the first frame, since the load describes the frame
+        // before.
+        if (frame_ > 1) load_ += get_load_percent();
+
+        auto start = Clock::now();
+        particles_.update(dt);
+        update_ms_ += std::chrono::duration<double, std::milli>(
+                Clock::now() - start).count();
+
+        top_up_();
+
+        if (frame_ == frames_) {
+            report_();
+            quit();
+        }
+    }
+
+    void draw(Sprite_set& set) override
+    {
+        set.add_sprite(particles_, {0, 0});
+    }
+
+private:
+    void top_up_()
+    {
+        std::uniform_real_distribution<float> x(0, float(screen.width));
+        std::uniform_real_distribution<float> y(0, screen.height / 2.f);
+        std::uniform_real_distribution<float> speed(-100, 100);
+        std::uniform_real_distribution<double> lifetime(1, 3);
+        std::uniform_int_distribution<int> hue(0, 359);
+
+        while (particles_.size() < particles_.capacity()) {
+            particles_.emit({x(rng_), y(rng_)},
+                            {speed(rng_), speed(rng_)},
+                            Color::from_hsla(hue(rng_), 0.8, 0.6),
+                            lifetime(rng_));
+        }
+    }
+
+    void report_()
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "particles:       " << particles_.capacity() << '\n'
+                  << "update ms/frame: " << update_ms_ / frames_ << '\n'
+                  << "load:            " << load_ / (frames_ - 1) << "%\n";
+    }
+
+    Particle_system particles_;
+    int frames_;
+    int frame_ = 0;
+    std::mt19937 rng_{211};
+
+    double update_ms_ = 0;
+    double load_ = 0;
+};
+
+int main(int argc, char* argv[])
+{
+    int particles = 200000;
+    int frames = 300;
+
+    try {
+        if (argc > 1) particles = std::stoi(argv[1]);
+        if (argc > 2) frames = std::stoi(argv[2]);
+    } catch (std::exception const&) {
+        std::cerr << "Usage: " << argv[0] << " [PARTICLES [FRAMES]]\n";
+        return 2;
+    }
+
+    if (particles < 1) particles = 1;
+    if (frames < 2) frames = 2;
+
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+    Particles_bench(particles, frames).run();
+}
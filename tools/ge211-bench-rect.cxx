@@ -0,0 +1,109 @@
+// ge211-bench-rect: compares ways of visiting every position of a Rect
+// over a grid stored row by row.
+//
+// Usage: ge211-bench-rect [SIZE [REPEATS]]
+//
+// Fills a SIZE by SIZE grid (default 1024) of integers, and then sums
+// it REPEATS times (default 20) with each of:
+//
+//  - iterator: the Rect's own iterator, which goes column by column,
+//  - rows: Rect::rows(), with a plain loop across each row,
+//  - for_each_posn: Rect::for_each_posn() with a lambda.
+//
+// It reports the average milliseconds per pass for each. All three must
+// find the same sum.
+
+#include <ge211.hxx>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ge211;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millis_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+}
+
+template <typename SUM>
+uint64_t time_pass(char const* name, int repeats, SUM sum)
+{
+    uint64_t result = 0;
+
+    auto start = Clock::now();
+    for (int i = 0; i < repeats; ++i)
+        result += sum();
+    double ms = millis_since(start) / repeats;
+
+    std::cout << std::setw(14) << name << std::setw(12) << ms << '\n';
+    return result;
+}
+
+}  // end anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int size = 1024;
+    int repeats = 20;
+
+    try {
+        if (argc > 1) size = std::stoi(argv[1]);
+        if (argc > 2) repeats = std::stoi(argv[2]);
+    } catch (std::exception const&) {
+        std::cerr << "Usage: " << argv[0] << " [SIZE [REPEATS]]\n";
+        return 2;
+    }
+
+    if (size < 1) size = 1;
+    if (repeats < 1) repeats = 1;
+
+    std::vector<int> grid(size_t(size) * size);
+    for (size_t i = 0; i < grid.size(); ++i)
+        grid[i] = int(i % 251);
+
+    Rect<int> rect{0, 0, size, size};
+    int const* cells = grid.data();
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "        method   ms/pass\n";
+
+    uint64_t by_iterator = time_pass("iterator", repeats, [&] {
+        uint64_t sum = 0;
+        for (Posn<int> p : rect)
+            sum += cells[p.y * size + p.x];
+        return sum;
+    });
+
+    uint64_t by_rows = time_pass("rows", repeats, [&] {
+        uint64_t sum = 0;
+        for (auto row : rect.rows()) {
+            int const* line = cells + row.y * size;
+            for (int x = row.x_begin; x < row.x_end; ++x)
+                sum += line[x];
+        }
+        return sum;
+    });
+
+    uint64_t by_each = time_pass("for_each_posn", repeats, [&] {
+        uint64_t sum = 0;
+        rect.for_each_posn([&](Posn<int> p) {
+            sum += cells[p.y * size + p.x];
+        });
+        return sum;
+    });
+
+    if (by_iterator != by_rows || by_iterator != by_each) {
+        std::cout << "MISMATCH\n";
+        return 1;
+    }
+}
@@ -0,0 +1,107 @@
+// ge211-bench-spatial-hash: compares finding overlapping pairs with a
+// Spatial_hash against testing every pair.
+//
+// Usage: ge211-bench-spatial-hash [MAX_OBJECTS]
+//
+// For 1,000 objects, and then ten times as many up to MAX_OBJECTS
+// (default 100,000), scatters squares of 8 to 24 units over a world
+// sized so that the density stays the same, then times:
+//
+//  - all pairs: testing each pair of bounds once,
+//  - hash update: moving every object and updating the spatial hash,
+//  - hash query: querying each object's bounds and counting the pairs.
+//
+// The two methods must find the same number of overlapping pairs. All
+// pairs is quadratic, so at 100,000 objects it takes several seconds.
+
+#include <ge211.hxx>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ge211;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millis_since(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+}
+
+bool overlap(Rect<float> const& a, Rect<float> const& b)
+{
+    return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+           a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+void run(size_t count, std::mt19937& rng)
+{
+    float world = std::sqrt(float(count) * 2000);
+    std::uniform_real_distribution<float> coord(0, world);
+    std::uniform_real_distribution<float> size(8, 24);
+    std::uniform_real_distribution<float> step(-2, 2);
+
+    std::vector<Rect<float>> rects;
+    for (size_t i = 0; i < count; ++i)
+        rects.push_back({coord(rng), coord(rng), size(rng), size(rng)});
+
+    Spatial_hash<float> grid(32);
+    for (auto const& rect : rects) grid.insert(rect);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        rects[i].x += step(rng);
+        rects[i].y += step(rng);
+        grid.update(Spatial_hash<float>::Handle(i), rects[i]);
+    }
+    double update_ms = millis_since(start);
+
+    start = Clock::now();
+    size_t naive_pairs = 0;
+    for (size_t i = 0; i < count; ++i)
+        for (size_t j = i + 1; j < count; ++j)
+            if (overlap(rects[i], rects[j])) ++naive_pairs;
+    double naive_ms = millis_since(start);
+
+    start = Clock::now();
+    size_t hash_pairs = 0;
+    for (size_t i = 0; i < count; ++i) {
+        grid.query(rects[i], [&](Spatial_hash<float>::Handle other) {
+            if (other > i) ++hash_pairs;
+        });
+    }
+    double query_ms = millis_since(start);
+
+    std::cout << std::setw(8) << count
+              << std::setw(14) << naive_ms
+              << std::setw(14) << update_ms
+              << std::setw(14) << query_ms
+              << std::setw(12) << hash_pairs
+              << (hash_pairs == naive_pairs ? "" : "  MISMATCH") << '\n';
+
+    if (hash_pairs != naive_pairs) std::exit(1);
+}
+
+}  // end anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    size_t max_objects = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                  : 100000;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << " objects  all pairs ms  hash update ms"
+              << " hash query ms       pairs\n";
+
+    std::mt19937 rng(211);
+    for (size_t count = 1000; count <= max_objects; count *= 10)
+        run(count, rng);
+}
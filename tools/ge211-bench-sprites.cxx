@@ -0,0 +1,171 @@
+// ge211-bench-sprites: measures the cost of adding sprites to the
+// Sprite_set and painting them.
+//
+// Usage: ge211-bench-sprites [SPRITES [FRAMES]]
+//
+// Adds SPRITES small sprites (default 20,000) every frame for FRAMES
+// frames (default 300) in each of four phases:
+//
+//  - identity: on screen, without transforms,
+//  - bulk: the same, but added with one call to add_sprites,
+//  - rotated: on screen, each rotated, so that transforms are stored,
+//  - culled: off screen, so that nothing is drawn and only adding,
+//    culling and sorting remain.
+//
+// For each phase it reports the time spent in add_sprite and the
+// engine's busy time per frame, both per frame and per sprite.
+//
+// Unless SDL_VIDEODRIVER is already set, this uses SDL's "dummy" video
+// driver, which renders in software without a display.
+
+#include <ge211.hxx>
+
+#include <SDL.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ge211;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Dims<int> const screen{800, 600};
+
+char const* const phase_names[] = {"identity", "bulk", "rotated", "culled"};
+int const phase_count = 4;
+
+}  // end anonymous namespace
+
+class Sprites_bench : public Abstract_game
+{
+public:
+    Sprites_bench(int sprites, int frames)
+            : sprite_count_(sprites),
+              frames_(frames)
+    { }
+
+protected:
+    Dims<int> initial_window_dimensions() const override
+    {
+        return screen;
+    }
+
+    void on_start() override
+    {
+        std::mt19937 rng(211);
+        std::uniform_int_distribution<int> x(0, screen.width - 16);
+        std::uniform_int_distribution<int> y(0, screen.height - 16);
+        std::uniform_int_distribution<int> z(0, 7);
+
+        for (int i = 0; i < sprite_count_; ++i) {
+            positions_.push_back({x(rng), y(rng)});
+            zs_.push_back(z(rng));
+        }
+
+        std::cout << "   phase   add ms/frame  add ns/sprite"
+                     "  busy ms/frame  busy ns/sprite\n";
+    }
+
+    void on_frame(double) override
+    {
+        ++frame_;
+
+        // Skip the first frame of each phase, since the load describes
+        // the frame before.
+        if (frame_ % frames_ != 1)
+            busy_ms_ += get_load_percent() / 100 *
+                        get_prev_frame_length().seconds() * 1000;
+
+        if (frame_ % frames_ != 0) return;
+
+        report_();
+
+        if (++phase_ == phase_count) quit();
+    }
+
+    void draw(Sprite_set& set) override
+    {
+        auto start = Clock::now();
+
+        switch (phase_) {
+        case 0:
+            for (int i = 0; i < sprite_count_; ++i)
+                set.add_sprite(tile_, positions_[i], zs_[i]);
+            break;
+
+        case 1:
+            set.add_sprites(tile_, positions_, zs_);
+            break;
+
+        case 2:
+            for (int i = 0; i < sprite_count_; ++i)
+                set.add_sprite(tile_, positions_[i], zs_[i],
+                               Transform::rotation(i % 360));
+            break;
+
+        default:
+            for (int i = 0; i < sprite_count_; ++i)
+                set.add_sprite(tile_, positions_[i].down_by(screen.height),
+                               zs_[i]);
+        }
+
+        add_ms_ += std::chrono::duration<double, std::milli>(
+                Clock::now() - start).count();
+    }
+
+private:
+    void report_()
+    {
+        double add_ms = add_ms_ / frames_;
+        double busy_ms = busy_ms_ / (frames_ - 1);
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << phase_names[phase_]
+                  << std::setw(15) << add_ms
+                  << std::setw(15) << add_ms * 1e6 / sprite_count_
+                  << std::setw(15) << busy_ms
+                  << std::setw(16) << busy_ms * 1e6 / sprite_count_
+                  << '\n';
+
+        add_ms_ = busy_ms_ = 0;
+    }
+
+    int sprite_count_;
+    int frames_;
+    int frame_ = 0;
+    int phase_ = 0;
+    std::vector<Posn<int>> positions_;
+    std::vector<int> zs_;
+    Rectangle_sprite tile_{{16, 16}, Color::medium_blue()};
+
+    double add_ms_ = 0;
+    double busy_ms_ = 0;
+};
+
+int main(int argc, char* argv[])
+{
+    int sprites = 20000;
+    int frames = 300;
+
+    try {
+        if (argc > 1) sprites = std::stoi(argv[1]);
+        if (argc > 2) frames = std::stoi(argv[2]);
+    } catch (std::exception const&) {
+        std::cerr << "Usage: " << argv[0] << " [SPRITES [FRAMES]]\n";
+        return 2;
+    }
+
+    if (sprites < 1) sprites = 1;
+    if (frames < 2) frames = 2;
+
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+    Sprites_bench(sprites, frames).run();
+}
@@ -0,0 +1,173 @@
+// ge211-bench-tile-map: compares drawing a large grid of tiles with a
+// Tile_map against adding a sprite for every visible tile.
+//
+// Usage: ge211-bench-tile-map [MAP_SIZE [FRAMES]]
+//
+// Fills a square map of MAP_SIZE by MAP_SIZE cells (default 1000) with
+// 16-pixel tiles, and scrolls diagonally across it for FRAMES frames
+// (default 300), first adding one sprite per visible tile each frame,
+// and then adding a single Tile_map. It reports the engine's load and
+// the number of sprites painted for each.
+//
+// Unless SDL_VIDEODRIVER is already set, this uses SDL's "dummy" video
+// driver, which renders in software without a display.
+
+#include <ge211.hxx>
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ge211;
+
+namespace {
+
+Dims<int> const screen{1024, 768};
+int const tile_size = 16;
+int const tile_count = 8;
+
+// A tileset of solid tiles, one per color, in a single row.
+class Tileset : public internal::Render_sprite
+{
+public:
+    Tileset()
+            : Render_sprite({tile_size * tile_count, tile_size})
+    {
+        for (int i = 0; i < tile_count; ++i)
+            fill_rectangle({i * tile_size, 0, tile_size, tile_size},
+                           Color::from_hsla(360.0 * i / tile_count, .5, .5));
+    }
+};
+
+}  // end anonymous namespace
+
+class Tile_map_bench : public Abstract_game
+{
+public:
+    Tile_map_bench(int map_size, int frames)
+            : map_size_(map_size),
+              frames_(frames),
+              map_(tileset_, {tile_size, tile_size}, {map_size, map_size})
+    {
+        for (int i = 0; i < tile_count; ++i)
+            tiles_.emplace_back(Dims<int>{tile_size, tile_size},
+                                Color::from_hsla(360.0 * i / tile_count,
+                                                 .5, .5));
+    }
+
+protected:
+    Dims<int> initial_window_dimensions() const override
+    {
+        return screen;
+    }
+
+    void on_start() override
+    {
+        std::mt19937 rng(211);
+        std::uniform_int_distribution<int> tile(0, tile_count - 1);
+
+        for (int y = 0; y < map_size_; ++y)
+            for (int x = 0; x < map_size_; ++x)
+                map_.set_tile({x, y}, tile(rng));
+    }
+
+    void on_frame(double) override
+    {
+        ++frame_;
+
+        // Skip the first frame of each phase, since the load and count
+        // describe the frame before.
+        if (frame_ % frames_ != 1) {
+            load_  += get_load_percent();
+            drawn_ += get_drawn_sprite_count();
+        }
+
+        if (frame_ % frames_ != 0) return;
+
+        report_();
+
+        if (per_tile_)
+            per_tile_ = false;
+        else
+            quit();
+    }
+
+    void draw(Sprite_set& set) override
+    {
+        Dims<int> map_pixels = map_.dimensions();
+        int range = std::min(map_pixels.width - screen.width,
+                             map_pixels.height - screen.height);
+        int scroll = range > 0 ? frame_ * 4 % range : 0;
+        Posn<int> origin{-scroll, -scroll};
+
+        if (!per_tile_) {
+            set.add_sprite(map_, origin);
+            return;
+        }
+
+        int first = scroll / tile_size;
+        int end_x = std::min(map_size_,
+                             (scroll + screen.width) / tile_size + 1);
+        int end_y = std::min(map_size_,
+                             (scroll + screen.height) / tile_size + 1);
+
+        for (int y = first; y < end_y; ++y)
+            for (int x = first; x < end_x; ++x)
+                set.add_sprite(tiles_[size_t(map_.get_tile({x, y}))],
+                               origin.right_by(x * tile_size)
+                                     .down_by(y * tile_size));
+    }
+
+private:
+    void report_()
+    {
+        double samples = frames_ - 1;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << (per_tile_ ? "per tile:" : "tile map:")
+                  << "  load " << std::setw(5) << load_ / samples << "%"
+                  << "  sprites " << std::setw(8) << drawn_ / samples
+                  << '\n';
+
+        load_ = drawn_ = 0;
+    }
+
+    int map_size_;
+    int frames_;
+    int frame_ = 0;
+    bool per_tile_ = true;
+
+    Tileset tileset_;
+    Tile_map map_;
+    std::vector<Rectangle_sprite> tiles_;
+
+    double load_ = 0;
+    double drawn_ = 0;
+};
+
+int main(int argc, char* argv[])
+{
+    int map_size = 1000;
+    int frames = 300;
+
+    try {
+        if (argc > 1) map_size = std::stoi(argv[1]);
+        if (argc > 2) frames = std::stoi(argv[2]);
+    } catch (std::exception const&) {
+        std::cerr << "Usage: " << argv[0] << " [MAP_SIZE [FRAMES]]\n";
+        return 2;
+    }
+
+    if (map_size < 1) map_size = 1;
+    if (frames < 2) frames = 2;
+
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+    Tile_map_bench(map_size, frames).run();
+}
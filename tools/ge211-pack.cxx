@@ -0,0 +1,85 @@
+// ge211-pack: bundles resource files into a GE211 resource pack.
+//
+// Usage: ge211-pack [-C DIR] OUTPUT FILE...
+//
+// Each FILE is stored under its name as given, which is the name that
+// the game will use to load it. With `-C DIR`, files are read relative
+// to DIR. For example, to pack a game's whole Resources/ directory:
+//
+//     ge211-pack -C Resources Resources/ge211.pack tiles.png pop.ogg
+//
+// At startup, GE211 looks for `ge211.pack` in the same places it looks
+// for other resources, and then serves the images, sounds, music and
+// fonts it contains from memory. Files that the game opens itself, with
+// open_resource_file() or open_binary_resource_file(), are only read
+// from the Resources/ directories, so don't pack those.
+
+#include <ge211/error.hxx>
+#include <ge211/pack.hxx>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+using ge211::detail::Resource_pack;
+
+static int usage(char const* argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [-C DIR] OUTPUT FILE...\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string dir;
+    int arg = 1;
+
+    if (arg + 1 < argc && std::string(argv[arg]) == "-C") {
+        dir = argv[arg + 1];
+        if (!dir.empty() && dir.back() != '/') dir += '/';
+        arg += 2;
+    }
+
+    if (arg + 2 > argc) return usage(argv[0]);
+
+    std::string output = argv[arg++];
+    std::vector<std::pair<std::string, std::string>> files;
+
+    for (; arg < argc; ++arg) {
+        std::string name = argv[arg];
+        std::ifstream in(dir + name, std::ios_base::in | std::ios_base::binary);
+        if (!in) {
+            std::cerr << argv[0] << ": could not read " << dir + name << "\n";
+            return 1;
+        }
+
+        files.emplace_back(name,
+                           std::string(std::istreambuf_iterator<char>(in),
+                                       std::istreambuf_iterator<char>()));
+    }
+
+    std::ofstream out(output,
+                      std::ios_base::out | std::ios_base::binary |
+                      std::ios_base::trunc);
+    if (!out) {
+        std::cerr << argv[0] << ": could not write " << output << "\n";
+        return 1;
+    }
+
+    try {
+        Resource_pack::write(out, std::move(files));
+    } catch (ge211::Client_logic_error const& e) {
+        std::cerr << argv[0] << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    if (!out.flush()) {
+        std::cerr << argv[0] << ": error writing " << output << "\n";
+        return 1;
+    }
+
+    return 0;
+}